@@ -0,0 +1,64 @@
+#ifndef BLINKSCHEDULER_H
+#define BLINKSCHEDULER_H
+
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+
+// Runs the blink schedules of any number of leds from one k_timer: the
+// next deadlines are kept in a min-heap and the timer is always armed for
+// the earliest one, the expiry toggles every led that is due. No thread or
+// stack per led, no context switch per blink.
+//
+// Toggle() runs in the timer ISR, so the led must be ISR safe to toggle.
+class BlinkScheduler {
+public:
+  constexpr static size_t kMaxBlinks = 8;
+
+private:
+  using toggle_fn_t = int (*)(void *led);
+
+  struct blink_entry {
+    toggle_fn_t toggle;
+    void *led;
+    k_ticks_t period; // 0 -> stopped, not in the heap
+    int64_t deadline; // absolute, in ticks
+  };
+
+  blink_entry m_entries[kMaxBlinks];
+  size_t m_count = 0;
+
+  uint8_t m_heap[kMaxBlinks];     // entry ids, earliest deadline first
+  uint8_t m_heap_pos[kMaxBlinks]; // entry id -> heap slot
+  size_t m_heap_size = 0;
+
+  k_timer m_timer;
+  k_spinlock m_lock;
+
+  static void TimerExpiry(k_timer *timer);
+  int Add(toggle_fn_t toggle, void *led, uint32_t period_ms);
+  void Rearm();
+  bool Earlier(size_t a, size_t b) const;
+  void Swap(size_t a, size_t b);
+  void SiftUp(size_t slot);
+  void SiftDown(size_t slot);
+  void HeapInsert(uint8_t id);
+  void HeapRemove(uint8_t id);
+
+public:
+  BlinkScheduler() = default;
+  void Init();
+
+  // Returns the schedule id used by SetRate(), or -ENOMEM when full.
+  template <typename LedT> int Add(LedT &led, uint32_t period_ms) {
+    return Add([](void *p) { return static_cast<LedT *>(p)->Toggle(); }, &led,
+               period_ms);
+  }
+
+  // New toggle period, effective from now; 0 stops the led where it is.
+  int SetRate(int id, uint32_t period_ms);
+  uint32_t Rate(int id) const;
+
+  ~BlinkScheduler() = default;
+};
+
+#endif // BLINKSCHEDULER_H
@@ -2,11 +2,17 @@
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/kernel.h>
 
+#include "blinkscheduler.h"
 #include "led.h"
 
 #define DELAY1 (200U)
 #define DELAY2 (500U)
 
+// BLINK_SCHEDULER: 0-> one thread per blink rate; 1-> both blinks from one
+// k_timer (no blink threads or stacks)
+#define BLINK_SCHEDULER 1
+
+#if !BLINK_SCHEDULER
 // Threads
 #if CONFIG_BOARD_ESP_WROVER_KIT
 constexpr size_t kThreadStackSize = 4 * 1024;
@@ -24,12 +30,37 @@ K_THREAD_STACK_DEFINE(stack_thread_0, kThreadStackSize);
 
 constexpr int thread_1_prio = 1;
 constexpr int thread_0_prio = 1;
+#endif
 
 // In the corresponding DT overlays, we defined same gpio pin with same alias
 constexpr gpio_dt_spec led_pin = GPIO_DT_SPEC_GET(DT_ALIAS(userled0), gpios);
 
 Led led{led_pin};
 
+#if BLINK_SCHEDULER
+BlinkScheduler blink_scheduler;
+
+extern "C" int main(void) {
+
+  if (led.Init()) {
+    return 0;
+  }
+
+  // the two blink threads, as schedules on one timer
+  std::cout << "Starting blink schedules ..." << std::endl;
+
+  blink_scheduler.Init();
+  blink_scheduler.Add(led, DELAY1);
+  blink_scheduler.Add(led, DELAY2);
+
+  while (true) {
+    // Do nothing
+    k_msleep(2 * DELAY2);
+  }
+
+  return 0;
+}
+#else
 static void led_toggle_thread(void *param1, void *param2, void *param3) {
   const uint8_t thread_no = *((const uint8_t *)param1);
   const uint32_t led_delay = thread_no ? DELAY2 : DELAY1;
@@ -74,3 +105,4 @@ extern "C" int main(void) {
 
   return 0;
 }
+#endif
@@ -0,0 +1,64 @@
+#ifndef BLINKPATTERN_H
+#define BLINKPATTERN_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// A blink pattern is a constexpr list of durations in ms, alternating led
+// on / led off and starting with on. The step tables live in flash, playing
+// them back (PatternPlayer) needs no heap and no copies.
+struct BlinkPattern {
+  const uint16_t *steps;
+  size_t len; // even: every on step has its off step
+  bool repeat;
+
+  template <size_t N>
+  constexpr BlinkPattern(const uint16_t (&user_steps)[N], bool user_repeat)
+      : steps(user_steps), len(N), repeat(user_repeat) {
+    static_assert(N % 2 == 0, "on/off pairs");
+  }
+
+  template <size_t N>
+  constexpr BlinkPattern(const std::array<uint16_t, N> &user_steps,
+                         bool user_repeat)
+      : steps(user_steps.data()), len(N), repeat(user_repeat) {
+    static_assert(N % 2 == 0, "on/off pairs");
+  }
+};
+
+// kCode short blinks, then a long pause: error code 3 -> "... ..."
+template <uint8_t kCode, uint16_t kShort = 200, uint16_t kPause = 1500>
+constexpr std::array<uint16_t, 2 * kCode> MakeErrorCode() {
+  static_assert(kCode > 0, "error code 0 would be an empty pattern");
+  std::array<uint16_t, 2 * kCode> steps{};
+  for (size_t i = 0; i < kCode; i++) {
+    steps[2 * i] = kShort;
+    steps[2 * i + 1] = kShort;
+  }
+  steps[2 * kCode - 1] = kPause;
+  return steps;
+}
+
+namespace blink_patterns {
+
+constexpr uint16_t kSlowSteps[] = {500, 500}; // DELAY2
+constexpr uint16_t kFastSteps[] = {200, 200}; // DELAY1
+constexpr uint16_t kHeartbeatSteps[] = {100, 150, 100, 650};
+// ... --- ... with 200 ms dot, 600 ms dash, 1400 ms word gap
+constexpr uint16_t kSosSteps[] = {200, 200, 200, 200, 200, 600,
+                                  600, 200, 600, 200, 600, 600,
+                                  200, 200, 200, 200, 200, 1400};
+constexpr auto kError3Steps = MakeErrorCode<3>();
+constexpr uint16_t kFlashSteps[] = {50, 50};
+
+constexpr BlinkPattern kSlow{kSlowSteps, true};
+constexpr BlinkPattern kFast{kFastSteps, true};
+constexpr BlinkPattern kHeartbeat{kHeartbeatSteps, true};
+constexpr BlinkPattern kSos{kSosSteps, true};
+constexpr BlinkPattern kError3{kError3Steps, true};
+constexpr BlinkPattern kFlashOnce{kFlashSteps, false};
+
+} // namespace blink_patterns
+
+#endif // BLINKPATTERN_H
@@ -1,3 +1,6 @@
+#ifndef LED_H
+#define LED_H
+
 #include <zephyr/drivers/gpio.h>
 
 class Led {
@@ -15,4 +18,6 @@ public:
   int On();
   int Off();
   ~Led() = default;
-};
\ No newline at end of file
+};
+
+#endif // LED_H
@@ -0,0 +1,50 @@
+#ifndef PATTERNPLAYER_H
+#define PATTERNPLAYER_H
+
+#include <atomic>
+
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+
+#include "blinkpattern.h"
+#include "led.h"
+
+// Plays BlinkPatterns on a Led from a k_timer: one expiry per step, the
+// timer is re-armed with the duration of the step it just applied.
+// Play() can be called from any thread (or ISR), the new pattern is
+// swapped in atomically and starts right away from its first step.
+class PatternPlayer {
+public:
+  struct Stats {
+    uint32_t steps;
+    uint32_t avg_cycles; // time spent in the timer expiry, per step
+    uint32_t max_cycles;
+  };
+
+private:
+  Led &m_led;
+  k_timer m_timer;
+
+  std::atomic<const BlinkPattern *> m_pending{nullptr};
+  const BlinkPattern *m_pattern = nullptr; // timer context only
+  size_t m_step = 0;
+
+  // ISR cost per step, reset by GetStats()
+  uint32_t m_steps = 0;
+  uint64_t m_total_cycles = 0;
+  uint32_t m_max_cycles = 0;
+  k_spinlock m_stats_lock;
+
+  static void TimerExpiry(k_timer *timer);
+  void Step();
+
+public:
+  PatternPlayer(Led &led);
+  void Init();
+  void Play(const BlinkPattern &pattern);
+  void Stop();
+  Stats GetStats();
+  ~PatternPlayer() = default;
+};
+
+#endif // PATTERNPLAYER_H
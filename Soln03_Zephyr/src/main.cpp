@@ -7,11 +7,17 @@
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/drivers/uart.h>
 
+#include "command.h"
 #include "led.h"
+#include "patternplayer.h"
 
 #define DELAY1 (200U)
 #define DELAY2 (500U)
-#define UART_DELAY (100U)
+
+// LED_PATTERN: 0-> led thread blinking at led_delay; 1-> constexpr patterns
+// played from a k_timer, selected with "pattern <n>"
+#define LED_PATTERN 0
+
 // Threads
 #if CONFIG_BOARD_ESP_WROVER_KIT
 constexpr const size_t kThreadStackSize = 4 * 1024;
@@ -39,8 +45,19 @@ constexpr const device *uart_port = (DEVICE_DT_GET(DT_ALIAS(usercom0)));
 
 static std::atomic<uint32_t> led_delay = DELAY2;
 
+// raised by the uart rx irq, the reader k_poll()s on it
+static k_poll_signal uart_rx_signal;
+
 Led led{led_pin};
 
+#if LED_PATTERN
+PatternPlayer led_player{led};
+
+constexpr const BlinkPattern *led_patterns[] = {
+    &blink_patterns::kSlow, &blink_patterns::kFast,
+    &blink_patterns::kHeartbeat, &blink_patterns::kSos,
+    &blink_patterns::kError3, &blink_patterns::kFlashOnce};
+#else
 static void led_toggle_thread(void *param1, void *param2, void *param3) {
 
   while (true) {
@@ -54,48 +71,118 @@ static void led_toggle_thread(void *param1, void *param2, void *param3) {
   }
 }
 
+// uart commands
+static int cmd_delay(const CommandArgs &args) {
+  if (!args.value[1]) {
+    std::cout << "\n\rEnter only numbers[0-9], No delay time update!"
+              << std::endl;
+    return 0; // already reported
+  }
+  k_thread_suspend(thread_1_tid); // Immediate effect: Suspend the led task as
+                                  // it is currently blocked due to k_msleep()
+  led_delay.store(args.value[1]);
+  std::cout << "\n\rUpdate delay time to: " << args.value[1] << "ms"
+            << std::endl;
+  k_thread_resume(thread_1_tid); // Immediate effect: Start blinking with new
+                                 // delay time
+  return 0;
+}
+#endif
+
+#if LED_PATTERN
+static int cmd_pattern(const CommandArgs &args) {
+  if (args.value[1] >= ARRAY_SIZE(led_patterns)) {
+    std::cout << "\n\rpatterns: 0 slow, 1 fast, 2 heartbeat, 3 sos, "
+                 "4 error 3, 5 flash once"
+              << std::endl;
+    return 0;
+  }
+  led_player.Play(*led_patterns[args.value[1]]);
+  std::cout << "\n\rPlaying pattern: " << args.value[1] << std::endl;
+  return 0;
+}
+
+static int cmd_bench(const CommandArgs &args) {
+  PatternPlayer::Stats stats = led_player.GetStats();
+  std::cout << "\n\rsteps: " << stats.steps
+            << ", isr cycles avg: " << stats.avg_cycles
+            << ", max: " << stats.max_cycles << " (@"
+            << sys_clock_hw_cycles_per_sec() << " Hz)" << std::endl;
+  return 0;
+}
+#endif
+
+constexpr Command uart_commands[] = {
+#if LED_PATTERN
+    {"bench", cmd_bench, {}},
+    {"pattern", cmd_pattern, {ArgType::kUint}},
+#else
+    {"delay", cmd_delay, {ArgType::kUint}},
+#endif
+};
+constexpr CommandTable uart_command_table{uart_commands};
+
+// Data stays in the fifo for uart_poll_in(), the irq masks itself and only
+// wakes the reader.
+static void uart_rx_irq(const device *dev, void *user_data) {
+  if (uart_irq_update(dev) && uart_irq_rx_ready(dev)) {
+    uart_irq_rx_disable(dev);
+    k_poll_signal_raise(&uart_rx_signal, 0);
+  }
+}
+
 static void uart_read_thread(void *param1, void *param2, void *param3) {
-  int ret = 0;
   size_t index = 0;
   unsigned char read_buff[100] = {'0'};
   size_t read_buff_size = sizeof(read_buff);
 
+  k_poll_event events[] = {K_POLL_EVENT_INITIALIZER(
+      K_POLL_TYPE_SIGNAL, K_POLL_MODE_NOTIFY_ONLY, &uart_rx_signal)};
+
   while (true) {
+    // sleep until the uart rx irq fires, no polling delay
+    k_poll(events, ARRAY_SIZE(events), K_FOREVER);
+    events[0].state = K_POLL_STATE_NOT_READY;
+
+    bool line_done = false;
+    while (!line_done && !uart_poll_in(uart_port, &read_buff[index])) {
+      uart_poll_out(uart_port, read_buff[index]);
+      line_done = (read_buff[index] == '\r' || read_buff[index] == '\n');
+      index++;
+
+      if (index > read_buff_size - 1) {
+        index = read_buff_size - 1;
+        line_done = true;
+      }
+    }
 
-    do {
-      if ((ret = uart_poll_in(uart_port, &read_buff[index])) == 0) {
-        uart_poll_out(uart_port, read_buff[index++]);
-        if (index > read_buff_size - 1) {
-          index = read_buff_size - 1;
-          break;
-        }
+    if (line_done) {
+      read_buff[index] = '\0';
+      CommandArgs args;
+      int argc = CommandTokenize(reinterpret_cast<char *>(read_buff),
+                                 args.argv, kCmdMaxArgs);
+      args.argc = (argc < 0) ? 0 : argc; // -E2BIG: too many tokens
+
+#if LED_PATTERN
+      if (argc < 0 || uart_command_table.Dispatch(args)) {
+        std::cout << "\n\rUsage: pattern <n> or bench" << std::endl;
       }
-      k_msleep(3 * UART_DELAY);
-    } while (!ret);
-
-    read_buff[index] = '\0';
-
-    if (index) {
-      sscanf((const char *)read_buff, "%[0-9]s", read_buff);
-
-      if ((atoi((const char *)read_buff))) {
-        k_thread_suspend(
-            thread_1_tid); // Immediate effect: Suspend the led task as it is
-                           // currently blocked due to k_msleep()
-        led_delay.store((atoi((const char *)read_buff)));
-        std::cout << "\n\rUpdate delay time to: "
-                  << atoi((const char *)read_buff) << "ms" << std::endl;
-        k_thread_resume(thread_1_tid); // Immediate effect: Start blinking
-        // with
-        //  new delay time
-      } else {
-        std::cout << "\n\rEnter only numbers[0-9], No delay time update!"
+#else
+      // a bare number is still accepted as "delay <ms>"
+      if (argc == 1 && CommandParseUint(args.argv[0], args.value[1])) {
+        cmd_delay(args);
+      } else if (argc < 0 || uart_command_table.Dispatch(args)) {
+        std::cout << "\n\rUsage: delay <ms> or <ms>, No delay time update!"
                   << std::endl;
       }
+#endif
       memset(read_buff, 0, index); // Clear the buffer
       index = 0;
     }
-    k_msleep(UART_DELAY);
+    k_poll_signal_reset(&uart_rx_signal);
+    // rx ready is level triggered: bytes that came in after the last read
+    // fire the irq again right away
+    uart_irq_rx_enable(uart_port);
   }
 }
 
@@ -110,17 +197,31 @@ extern "C" int main(void) {
     k_msleep(2 * DELAY2);
   }
 
+  k_poll_signal_init(&uart_rx_signal);
+  if (uart_irq_callback_user_data_set(uart_port, uart_rx_irq, nullptr)) {
+    std::cout << "uart rx irq setup failed..." << std::endl;
+    return 0;
+  }
+  uart_irq_rx_enable(uart_port);
+
   std::cout << "Starting Uart Thread ..." << std::endl;
 
   thread_0_tid = k_thread_create(
       &thread_0, stack_thread_0, K_THREAD_STACK_SIZEOF(stack_thread_0),
       uart_read_thread, NULL, NULL, NULL, thread_0_prio, K_USER, K_NO_WAIT);
 
+#if LED_PATTERN
+  std::cout << "Starting LED pattern ..." << std::endl;
+
+  led_player.Init();
+  led_player.Play(blink_patterns::kHeartbeat);
+#else
   std::cout << "Starting LED Thread ..." << std::endl;
 
   thread_1_tid = k_thread_create(
       &thread_1, stack_thread_1, K_THREAD_STACK_SIZEOF(stack_thread_1),
       led_toggle_thread, NULL, NULL, NULL, thread_1_prio, K_USER, K_NO_WAIT);
+#endif
 
   while (true) {
     // Do nothing
@@ -0,0 +1,78 @@
+#include "patternplayer.h"
+
+PatternPlayer::PatternPlayer(Led &led) : m_led(led) {}
+
+void PatternPlayer::Init() {
+  k_timer_init(&m_timer, TimerExpiry, NULL);
+  k_timer_user_data_set(&m_timer, this);
+}
+
+void PatternPlayer::Play(const BlinkPattern &pattern) {
+  m_pending.store(&pattern);
+  // expire now: the next step is the first step of the new pattern
+  k_timer_start(&m_timer, K_NO_WAIT, K_NO_WAIT);
+}
+
+void PatternPlayer::Stop() {
+  k_timer_stop(&m_timer);
+  m_pending.store(nullptr);
+  m_pattern = nullptr;
+  m_led.Off();
+}
+
+PatternPlayer::Stats PatternPlayer::GetStats() {
+  k_spinlock_key_t key = k_spin_lock(&m_stats_lock);
+  Stats stats = {.steps = m_steps,
+                 .avg_cycles = m_steps ? (uint32_t)(m_total_cycles / m_steps)
+                                       : 0,
+                 .max_cycles = m_max_cycles};
+  m_steps = 0;
+  m_total_cycles = 0;
+  m_max_cycles = 0;
+  k_spin_unlock(&m_stats_lock, key);
+  return stats;
+}
+
+void PatternPlayer::TimerExpiry(k_timer *timer) {
+  PatternPlayer *self =
+      static_cast<PatternPlayer *>(k_timer_user_data_get(timer));
+
+  uint32_t start = k_cycle_get_32();
+  self->Step();
+  uint32_t cycles = k_cycle_get_32() - start;
+
+  k_spinlock_key_t key = k_spin_lock(&self->m_stats_lock);
+  self->m_steps++;
+  self->m_total_cycles += cycles;
+  if (cycles > self->m_max_cycles) {
+    self->m_max_cycles = cycles;
+  }
+  k_spin_unlock(&self->m_stats_lock, key);
+}
+
+void PatternPlayer::Step() {
+  const BlinkPattern *pending = m_pending.exchange(nullptr);
+  if (pending != nullptr) {
+    m_pattern = pending;
+    m_step = 0;
+  }
+  if (m_pattern == nullptr) {
+    return;
+  }
+
+  if (m_step == m_pattern->len) {
+    if (!m_pattern->repeat) {
+      m_pattern = nullptr;
+      m_led.Off();
+      return;
+    }
+    m_step = 0;
+  }
+
+  if (m_step % 2 == 0) {
+    m_led.On();
+  } else {
+    m_led.Off();
+  }
+  k_timer_start(&m_timer, K_MSEC(m_pattern->steps[m_step++]), K_NO_WAIT);
+}
@@ -0,0 +1,75 @@
+#ifndef LINEMAILBOX_H
+#define LINEMAILBOX_H
+
+#include <atomic>
+#include <cstring>
+
+#include <zephyr/kernel.h>
+
+// Hands complete lines from a reader to a writer thread through kSlots
+// fixed line buffers taken from a k_mem_slab, no heap. The reader can be
+// up to kSlots lines ahead; when every slot is in use the new line is
+// dropped and counted, never blocking the reader.
+template <size_t kSlots, size_t kLineSize> class LineMailbox {
+public:
+  struct Line {
+    size_t len;
+    char data[kLineSize]; // always '\0' terminated
+  };
+
+private:
+  k_mem_slab m_slab;
+  char __aligned(sizeof(void *)) m_storage[kSlots * sizeof(Line)];
+
+  k_msgq m_queue; // Line pointers, in order
+  char __aligned(sizeof(void *)) m_queue_buffer[kSlots * sizeof(Line *)];
+
+  std::atomic<uint32_t> m_posted{0};
+  std::atomic<uint32_t> m_dropped{0};
+  uint32_t m_max_used = 0;
+
+public:
+  int Init() {
+    k_msgq_init(&m_queue, m_queue_buffer, sizeof(Line *), kSlots);
+    return k_mem_slab_init(&m_slab, m_storage, sizeof(Line), kSlots);
+  }
+
+  // Copies data (truncated to kLineSize - 1), returns -ENOMEM when full.
+  int Post(const char *data, size_t len) {
+    void *block;
+    if (k_mem_slab_alloc(&m_slab, &block, K_NO_WAIT)) {
+      m_dropped.fetch_add(1);
+      return -ENOMEM;
+    }
+
+    Line *line = static_cast<Line *>(block);
+    line->len = MIN(len, kLineSize - 1);
+    memcpy(line->data, data, line->len);
+    line->data[line->len] = '\0';
+
+    // cannot fail: the queue has one entry per slab block
+    k_msgq_put(&m_queue, &line, K_NO_WAIT);
+    m_posted.fetch_add(1);
+
+    uint32_t used = k_mem_slab_num_used_get(&m_slab);
+    if (used > m_max_used) {
+      m_max_used = used;
+    }
+    return 0;
+  }
+
+  // Oldest line or nullptr on timeout, give it back with Free().
+  Line *Fetch(k_timeout_t timeout) {
+    Line *line = nullptr;
+    k_msgq_get(&m_queue, &line, timeout);
+    return line;
+  }
+
+  void Free(Line *line) { k_mem_slab_free(&m_slab, line); }
+
+  uint32_t Posted() const { return m_posted.load(); }
+  uint32_t Dropped() const { return m_dropped.load(); }
+  uint32_t MaxUsed() const { return m_max_used; }
+};
+
+#endif // LINEMAILBOX_H
@@ -0,0 +1,107 @@
+#ifndef UARTASYNC_H
+#define UARTASYNC_H
+
+#include <atomic>
+#include <string_view>
+
+#include <zephyr/drivers/uart.h>
+#include <zephyr/kernel.h>
+
+#include "uartpolling.h"
+
+// Async (DMA) receive path: the driver fills two static buffers in
+// ping-pong, the callback only queues {buffer, offset, len} events and the
+// consumer gets completed lines as spans into those buffers (no copy).
+// A buffer goes back to the driver once every line pointing into it has
+// been released; if the consumer is too slow, rx stops and is counted as
+// an rx error instead of overwriting data still in use.
+class UartAsync {
+public:
+  struct Span {
+    const unsigned char *data;
+    size_t len;
+  };
+
+  // tail is only used when the line wrapped from one rx buffer to the other
+  struct Line {
+    Span head;
+    Span tail;
+    bool truncated; // rx stopped before the line terminator arrived
+  };
+
+private:
+  using ptr_device_const = const device *;
+  constexpr static ptr_device_const p_def_port =
+      (DEVICE_DT_GET(DT_ALIAS(usercom1)));
+  ptr_device_const m_port;
+
+  uart_config config;
+
+  constexpr static size_t kRxBufferSize = 64;
+  constexpr static size_t kRxBufferCount = 2; // ping-pong
+  constexpr static int32_t kRxTimeoutUs = 1000;
+  constexpr static size_t kRxQueueLength = 8;
+
+  enum class RxEventType : uint8_t { kReady, kStopped };
+
+  using rx_event_t = struct rx_event_st {
+    RxEventType type;
+    uint8_t buf;
+    uint16_t offset;
+    uint16_t len;
+  } __attribute__((aligned(4)));
+
+  uint8_t m_rx_buf[kRxBufferCount][kRxBufferSize];
+
+  k_msgq m_rx_queue;
+  char __aligned(4) m_rx_queue_buffer[kRxQueueLength * sizeof(rx_event_t)];
+
+  // buffer ownership, shared between the callback and the consumer
+  k_spinlock m_lock;
+  bool m_driver_owned[kRxBufferCount];
+  uint8_t m_holds[kRxBufferCount]; // queued segments + lines using it
+  bool m_rsp_pending;              // driver asked for a buffer, none free
+  bool m_rx_stopped;
+  bool m_stopping;                          // DeInit(), do not re-enable rx
+  std::atomic<uint32_t> m_dropped_bytes{0}; // event queue full
+  std::atomic<uint32_t> m_rx_errors{0};     // rx disabled/stopped by driver
+
+  // consumer side line assembly
+  rx_event_t m_seg;
+  size_t m_seg_pos;
+  bool m_seg_valid;
+  bool m_line_open;
+  bool m_line_wrapped;
+  uint8_t m_line_buf;
+  uint8_t m_tail_buf;
+  size_t m_line_off;
+  size_t m_head_len;
+  size_t m_line_len;
+
+  static void Callback(const device *dev, uart_event *evt, void *user_data);
+  void Hold(uint8_t buf);
+  void Drop(uint8_t buf);
+  void Recycle(uint8_t buf);
+  uint8_t IndexOf(const unsigned char *data) const;
+  void CloseLine(Line &line, bool truncated);
+
+public:
+  UartAsync(const ptr_device_const &p_user_port);
+  UartAsync(const ptr_device_const &p_user_port,
+            const uart_config &user_config);
+  int Init();
+  int IsReady();
+  int DeInit();
+  void Write(const unsigned char &buffer);
+  void Write(const uint8_t *buffer, size_t len);
+  void Write(std::string_view buffer);
+  // line stays valid (points into the rx buffers) until Release(line)
+  int ReadLine(Line &line, k_timeout_t timeout);
+  void Release(const Line &line);
+  uint32_t Dropped() const { return m_dropped_bytes.load(); }
+  uint32_t RxErrors() const { return m_rx_errors.load(); }
+
+  ~UartAsync() = default;
+};
+
+#endif // UARTASYNC_H
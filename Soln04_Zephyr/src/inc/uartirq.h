@@ -0,0 +1,93 @@
+#ifndef UARTIRQ_H
+#define UARTIRQ_H
+
+#include <atomic>
+#include <string_view>
+
+#include <zephyr/drivers/uart.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/ring_buffer.h>
+
+// Interrupt driven sibling of UartPolling: the uart ISR moves bytes between
+// the hardware fifo and the RX/TX ring buffers, readers sleep on a semaphore
+// until the ISR signals that data has arrived.
+//
+// Optional flow control throttles the sender on the rx ring fill level:
+// above kRxHighWater the sender is stopped (RTS deasserted or XOFF sent),
+// once the reader drains the ring below kRxLowWater it is released again.
+class UartIrq {
+public:
+  enum class FlowControl : uint8_t { kNone = 0, kRtsCts, kXonXoff };
+
+private:
+  using ptr_device_const = const device *;
+  constexpr static ptr_device_const p_def_port =
+      (DEVICE_DT_GET(DT_ALIAS(usercom1)));
+  ptr_device_const m_port;
+
+  constexpr static uart_config def_config = {.baudrate = 115200U,
+                                             .parity = UART_CFG_PARITY_NONE,
+                                             .stop_bits = UART_CFG_STOP_BITS_1,
+                                             .data_bits = UART_CFG_DATA_BITS_8,
+                                             .flow_ctrl =
+                                                 UART_CFG_FLOW_CTRL_NONE};
+  uart_config config;
+
+  // ring sizes must be a power of 2 for the ring_buf fast path
+  constexpr static size_t kRxBufferSize = 256;
+  constexpr static size_t kTxBufferSize = 256;
+
+  uint8_t m_rx_storage[kRxBufferSize];
+  uint8_t m_tx_storage[kTxBufferSize];
+  ring_buf m_rx_ring;
+  ring_buf m_tx_ring;
+
+  constexpr static size_t kRxHighWater = kRxBufferSize * 3 / 4;
+  constexpr static size_t kRxLowWater = kRxBufferSize / 4;
+  constexpr static uint8_t kXon = 0x11;
+  constexpr static uint8_t kXoff = 0x13;
+
+  FlowControl m_flow = FlowControl::kNone;
+  k_spinlock m_flow_lock;
+  volatile bool m_throttled = false; // sender told to stop
+  bool m_rx_stalled = false;         // rts/cts: ring full, rx irq masked
+  volatile bool m_tx_paused = false; // xon/xoff: host sent XOFF
+  volatile uint8_t m_flow_char = 0;  // XON/XOFF waiting for the tx irq
+  std::atomic<uint32_t> m_throttle_count{0};
+
+  k_sem m_rx_sem;          // ISR -> reader: rx ring has data
+  k_sem m_tx_sem;          // ISR -> writer: tx ring has space
+  k_sem m_resume_sem;      // ISR -> writer: host sent XON
+  k_spinlock m_tx_lock;    // several threads may write (echo + writer)
+  std::atomic<uint32_t> m_rx_dropped{0};
+
+  static void IrqHandler(const device *dev, void *user_data);
+  void HandleRx();
+  void HandleTx();
+  int FilterFlowChars(uint8_t *data, int len);
+  void Throttle();
+  void Unthrottle();
+  void SendFlowChar(uint8_t c);
+
+public:
+  UartIrq(const ptr_device_const &p_user_port);
+  UartIrq(const ptr_device_const &p_user_port,
+          const uart_config &user_config);
+  UartIrq(const ptr_device_const &p_user_port, FlowControl flow);
+  int Init();
+  int IsReady();
+  int DeInit();
+  void Write(const unsigned char &buffer);
+  // queued with one ring copy and one tx irq enable per chunk
+  void Write(const uint8_t *buffer, size_t len);
+  void Write(std::string_view buffer);
+  int Read(unsigned char &buffer);
+  int Read(unsigned char &buffer, k_timeout_t timeout);
+  uint32_t Dropped() const { return m_rx_dropped.load(); }
+  // how many times the sender had to be throttled
+  uint32_t Throttled() const { return m_throttle_count.load(); }
+
+  ~UartIrq() = default;
+};
+
+#endif // UARTIRQ_H
@@ -1,16 +1,26 @@
 #include <atomic>
+#include <cstdio>
 #include <cstring>
 #include <iostream>
-#include <string>
+#include <string_view>
 
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/kernel.h>
 
-#include "uartpolling.h"
+#include "linemailbox.h"
+#include "uartasync.h"
+#include "uartirq.h"
 
 #define DELAY1 (200U)
 #define DELAY2 (500U)
 #define UART_DELAY (100U)
+
+// UART_RX_ASYNC: 0-> irq driven (UartIrq); 1-> async/dma, zero-copy lines
+#define UART_RX_ASYNC 0
+
+// UART_FLOW (UartIrq only): 0-> none; 1-> rts/cts; 2-> xon/xoff
+#define UART_FLOW 0
+
 // Threads
 #if CONFIG_BOARD_ESP
 constexpr size_t kThreadStackSize = 4 * 1024;
@@ -33,81 +43,127 @@ constexpr int thread_1_prio = 1;
 constexpr const device *uart_port = (DEVICE_DT_GET(DT_ALIAS(usercom1)));
 
 // Led led{led_pin};
-UartPolling user_com_port{uart_port};
+#if UART_RX_ASYNC
+UartAsync user_com_port{uart_port};
+
+// Lines are handed over as spans into the rx buffers, not copied
+using line_msg_t = UartAsync::Line;
+constexpr size_t kLineQueueLength = 4;
+k_msgq line_queue_handle = {NULL};
+char __aligned(4) line_queue_buffer[kLineQueueLength * sizeof(line_msg_t)];
+#else
+constexpr UartIrq::FlowControl uart_flow =
+    static_cast<UartIrq::FlowControl>(UART_FLOW);
+UartIrq user_com_port{uart_port, uart_flow};
+
+// reader -> writer: several lines in flight, fixed buffers, no k_malloc
+// (drop counting and ordering are tested in tests/linemailbox)
+constexpr size_t kLineSlots = 4;
+constexpr size_t kLineSize = 100;
+LineMailbox<kLineSlots, kLineSize> line_mailbox;
+#endif
 
-// Shared buffer:
-using shared_ptr = char *;
-static std::atomic<shared_ptr> shared_data_ptr = NULL;
+#if UART_RX_ASYNC
+static void uart_write_thread(void *param1, void *param2, void *param3) {
 
+  constexpr std::string_view prompt_string = "\n\rYou entered:\n\r";
+  line_msg_t line;
+  while (true) {
+    if (!k_msgq_get(&line_queue_handle, &line, K_FOREVER)) {
+      user_com_port.Write(prompt_string);
+      user_com_port.Write(line.head.data, line.head.len);
+      user_com_port.Write(line.tail.data, line.tail.len);
+      user_com_port.Write("\n\r");
+      user_com_port.Release(line); // buffer can go back to the driver
+    }
+  }
+}
+
+static void uart_read_thread(void *param1, void *param2, void *param3) {
+  line_msg_t line;
+
+  while (true) {
+    if (user_com_port.ReadLine(line, K_FOREVER)) {
+      continue;
+    }
+    if (line.truncated) {
+      std::cout << "uart rx overrun, line truncated..." << std::endl;
+    }
+    if (k_msgq_put(&line_queue_handle, &line, K_NO_WAIT)) {
+      // writer is behind, drop the line and free its buffer
+      user_com_port.Release(line);
+    }
+  }
+}
+#else
 static void uart_write_thread(void *param1, void *param2, void *param3) {
 
-  std::string prompt_string = "\n\rYou entered:\n\r";
+  constexpr std::string_view prompt_string = "\n\rYou entered:\n\r";
   while (true) {
-    shared_ptr temp = shared_data_ptr.load();
-
-    if (temp != NULL) {
-      std::string print_string = prompt_string + std::string(temp) + "\n\r";
-      char *print = print_string.data();
-      while (*print != '\0') {
-        user_com_port.Write(static_cast<unsigned char>(*print++));
-      }
-      k_free(temp);
-      temp = NULL;
-      shared_data_ptr.store(temp);
+    auto *line = line_mailbox.Fetch(K_FOREVER);
+    if (line == nullptr) {
+      continue;
     }
-    k_msleep(UART_DELAY);
+    user_com_port.Write(prompt_string);
+    user_com_port.Write(reinterpret_cast<const uint8_t *>(line->data),
+                        line->len);
+    user_com_port.Write("\n\r");
+    line_mailbox.Free(line);
   }
 }
 
 static void uart_read_thread(void *param1, void *param2, void *param3) {
-  int ret = 0;
   size_t index = 0;
-  size_t read_buff_size = 100;
+  constexpr size_t read_buff_size = kLineSize;
   unsigned char read_buff[read_buff_size] = {'0'};
 
   while (true) {
 
-    do {
-      if ((ret = user_com_port.Read(read_buff[index])) == 0) {
-        user_com_port.Write(read_buff[index++]);
-        if (index > read_buff_size - 1) {
-          index = read_buff_size - 1;
-          break;
-        }
-      }
-      //k_msleep(2.5 * UART_DELAY);
-    } while (!ret);
+    // sleeps until the uart ISR signals new data, no polling delay
+    if (user_com_port.Read(read_buff[index], K_FOREVER)) {
+      continue;
+    }
+    user_com_port.Write(read_buff[index++]);
+    if (index > read_buff_size - 1) {
+      index = read_buff_size - 1;
+    }
 
     read_buff[index] = '\0';
 
     if (read_buff[index - 1] == '\n' || read_buff[index - 1] == '\r') {
-      shared_ptr temp = shared_data_ptr.load();
-      if (temp == NULL) {
-        temp = (char *)k_malloc((index + 1) * sizeof(char));
-        memcpy(temp, read_buff, index + 1);
-        shared_data_ptr.store(temp);
-        index = 0;
-      }
+      // all slots busy: the line is dropped and counted by the mailbox
+      line_mailbox.Post(reinterpret_cast<const char *>(read_buff), index);
+      index = 0;
     } else if(index > read_buff_size - 2) {
       std::cout << "uart read buffer overflow, resetting..." << std::endl;
       index = 0;
     }
-    k_msleep(UART_DELAY);
   }
 }
+#endif
 
 extern "C" int main(void) {
 
-  if (!user_com_port.Init()) {
-    std::cout << "uart config failed ..." << std::endl;
+#if UART_RX_ASYNC
+  k_msgq_init(&line_queue_handle, line_queue_buffer, sizeof(line_msg_t),
+              kLineQueueLength);
+#else
+  if (line_mailbox.Init()) {
+    std::cout << "line mailbox init failed ..." << std::endl;
     return 0;
   }
+#endif
 
   if (!user_com_port.IsReady()) {
     std::cout << "uart port not found..." << std::endl;
     return 0;
   }
 
+  if (user_com_port.Init()) {
+    std::cout << "uart rx config failed ..." << std::endl;
+    return 0;
+  }
+
   std::cout << "Starting uart read Thread ..." << std::endl;
 
   thread_0_tid = k_thread_create(
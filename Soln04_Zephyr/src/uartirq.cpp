@@ -0,0 +1,256 @@
+#include "uartirq.h"
+
+UartIrq::UartIrq(const ptr_device_const &p_user_port = p_def_port,
+                 const uart_config &user_config = def_config)
+    : m_port(p_user_port), config(user_config) {}
+
+UartIrq::UartIrq(const ptr_device_const &p_user_port = p_def_port)
+    : m_port(p_user_port), config(def_config) {}
+
+UartIrq::UartIrq(const ptr_device_const &p_user_port, FlowControl flow)
+    : m_port(p_user_port), config(def_config), m_flow(flow) {}
+
+int UartIrq::Init() {
+  ring_buf_init(&m_rx_ring, sizeof(m_rx_storage), m_rx_storage);
+  ring_buf_init(&m_tx_ring, sizeof(m_tx_storage), m_tx_storage);
+  k_sem_init(&m_rx_sem, 0, 1);
+  k_sem_init(&m_tx_sem, 0, 1);
+  k_sem_init(&m_resume_sem, 0, 1);
+  m_throttled = false;
+  m_rx_stalled = false;
+  m_tx_paused = false;
+  m_flow_char = 0;
+
+  if (m_flow == FlowControl::kRtsCts) {
+    config.flow_ctrl = UART_CFG_FLOW_CTRL_RTS_CTS;
+  }
+
+  // -ENOSYS: no runtime configuration, keep the devicetree settings
+  int ret = uart_configure(m_port, &config);
+  if (ret && ret != -ENOSYS) {
+    return ret;
+  }
+
+  uart_irq_rx_disable(m_port);
+  uart_irq_tx_disable(m_port);
+
+  ret = uart_irq_callback_user_data_set(m_port, IrqHandler, this);
+  if (ret) {
+    return ret;
+  }
+
+  // drop whatever was latched in the fifo before we took over
+  unsigned char dummy;
+  while (uart_fifo_read(m_port, &dummy, 1) > 0) {
+  }
+
+  uart_irq_rx_enable(m_port);
+#if CONFIG_UART_LINE_CTRL
+  if (m_flow == FlowControl::kRtsCts) {
+    // -ENOSYS: the driver only does automatic rts, which is fine too
+    (void)uart_line_ctrl_set(m_port, UART_LINE_CTRL_RTS, 1);
+  }
+#endif
+  return 0;
+}
+
+int UartIrq::IsReady() { return device_is_ready(m_port); }
+
+int UartIrq::DeInit() {
+  uart_irq_rx_disable(m_port);
+  uart_irq_tx_disable(m_port);
+  return 0;
+}
+
+void UartIrq::IrqHandler(const device *dev, void *user_data) {
+  UartIrq *self = static_cast<UartIrq *>(user_data);
+
+  while (uart_irq_update(dev) && uart_irq_is_pending(dev)) {
+    if (uart_irq_rx_ready(dev)) {
+      self->HandleRx();
+    }
+    if (uart_irq_tx_ready(dev)) {
+      self->HandleTx();
+    }
+  }
+}
+
+void UartIrq::HandleRx() {
+  uint8_t *data;
+  uint32_t space = ring_buf_put_claim(&m_rx_ring, &data, kRxBufferSize);
+
+  if (!space && m_flow == FlowControl::kRtsCts) {
+    // ring full: leave the bytes in the fifo and mask the irq, the uart
+    // holds RTS off once its fifo fills. Unthrottle() unmasks it.
+    k_spinlock_key_t key = k_spin_lock(&m_flow_lock);
+    uart_irq_rx_disable(m_port);
+    m_rx_stalled = true;
+    k_spin_unlock(&m_flow_lock, key);
+    k_sem_give(&m_rx_sem);
+    return;
+  }
+
+  if (!space) {
+    // ring full: the fifo must still be drained or the irq keeps firing.
+    // An XON in there must not be lost, or our tx stays paused.
+    uint8_t discard[8];
+    int len = FilterFlowChars(
+        discard, uart_fifo_read(m_port, discard, sizeof(discard)));
+    if (len > 0) {
+      m_rx_dropped.fetch_add(len);
+    }
+    k_sem_give(&m_rx_sem);
+    return;
+  }
+
+  int len = FilterFlowChars(data, uart_fifo_read(m_port, data, space));
+  ring_buf_put_finish(&m_rx_ring, len > 0 ? len : 0);
+
+  if (len > 0) {
+    if (ring_buf_size_get(&m_rx_ring) >= kRxHighWater) {
+      Throttle();
+    }
+    k_sem_give(&m_rx_sem);
+  }
+}
+
+int UartIrq::FilterFlowChars(uint8_t *data, int len) {
+  if (len <= 0 || m_flow != FlowControl::kXonXoff) {
+    return len;
+  }
+  // XON/XOFF from the host gate our tx, they are not data
+  int kept = 0;
+  for (int i = 0; i < len; i++) {
+    if (data[i] == kXoff) {
+      m_tx_paused = true;
+      k_sem_reset(&m_resume_sem);
+    } else if (data[i] == kXon) {
+      m_tx_paused = false;
+      uart_irq_tx_enable(m_port);
+      k_sem_give(&m_resume_sem);
+    } else {
+      data[kept++] = data[i];
+    }
+  }
+  return kept;
+}
+
+void UartIrq::HandleTx() {
+  if (m_flow_char) {
+    // a pending XON/XOFF goes out ahead of the queued data
+    k_spinlock_key_t key = k_spin_lock(&m_flow_lock);
+    uint8_t c = m_flow_char;
+    if (uart_fifo_fill(m_port, &c, 1) == 1) {
+      m_flow_char = 0;
+    }
+    k_spin_unlock(&m_flow_lock, key);
+    return;
+  }
+
+  if (m_tx_paused) {
+    // host sent XOFF: Write() keeps queueing, the irq comes back on XON
+    uart_irq_tx_disable(m_port);
+    return;
+  }
+
+  uint8_t *data;
+  uint32_t len = ring_buf_get_claim(&m_tx_ring, &data, kTxBufferSize);
+
+  if (!len) {
+    uart_irq_tx_disable(m_port);
+    k_sem_give(&m_tx_sem);
+    return;
+  }
+
+  int sent = uart_fifo_fill(m_port, data, len);
+  ring_buf_get_finish(&m_tx_ring, sent > 0 ? sent : 0);
+  k_sem_give(&m_tx_sem);
+}
+
+void UartIrq::SendFlowChar(uint8_t c) {
+  // called with m_flow_lock held, a newer XON/XOFF replaces an unsent one
+  m_flow_char = c;
+  uart_irq_tx_enable(m_port);
+}
+
+void UartIrq::Throttle() {
+  k_spinlock_key_t key = k_spin_lock(&m_flow_lock);
+
+  if (m_flow != FlowControl::kNone && !m_throttled) {
+    m_throttled = true;
+    m_throttle_count.fetch_add(1);
+    if (m_flow == FlowControl::kRtsCts) {
+#if CONFIG_UART_LINE_CTRL
+      (void)uart_line_ctrl_set(m_port, UART_LINE_CTRL_RTS, 0);
+#endif
+    } else {
+      SendFlowChar(kXoff);
+    }
+  }
+  k_spin_unlock(&m_flow_lock, key);
+}
+
+void UartIrq::Unthrottle() {
+  k_spinlock_key_t key = k_spin_lock(&m_flow_lock);
+
+  if (m_throttled) {
+    m_throttled = false;
+    if (m_flow == FlowControl::kRtsCts) {
+#if CONFIG_UART_LINE_CTRL
+      (void)uart_line_ctrl_set(m_port, UART_LINE_CTRL_RTS, 1);
+#endif
+      if (m_rx_stalled) {
+        m_rx_stalled = false;
+        uart_irq_rx_enable(m_port);
+      }
+    } else {
+      SendFlowChar(kXon);
+    }
+  }
+  k_spin_unlock(&m_flow_lock, key);
+}
+
+void UartIrq::Write(const unsigned char &buffer) { Write(&buffer, 1); }
+
+void UartIrq::Write(const uint8_t *buffer, size_t len) {
+  while (len) {
+    k_spinlock_key_t key = k_spin_lock(&m_tx_lock);
+    uint32_t put = ring_buf_put(&m_tx_ring, buffer, len);
+    k_spin_unlock(&m_tx_lock, key);
+
+    uart_irq_tx_enable(m_port);
+    buffer += put;
+    len -= put;
+    if (len && m_tx_paused) {
+      // host sent XOFF: nothing drains the ring until its XON
+      k_sem_take(&m_resume_sem, K_FOREVER);
+    } else if (len) {
+      // tx ring full: wait for the ISR to free some space
+      k_sem_take(&m_tx_sem, K_MSEC(10));
+    }
+  }
+}
+
+void UartIrq::Write(std::string_view buffer) {
+  Write(reinterpret_cast<const uint8_t *>(buffer.data()), buffer.size());
+}
+
+int UartIrq::Read(unsigned char &buffer) {
+  if (ring_buf_get(&m_rx_ring, &buffer, 1) != 1) {
+    buffer = '\0';
+    return -1;
+  }
+  if (m_throttled && ring_buf_size_get(&m_rx_ring) <= kRxLowWater) {
+    Unthrottle();
+  }
+  return 0;
+}
+
+int UartIrq::Read(unsigned char &buffer, k_timeout_t timeout) {
+  while (Read(buffer)) {
+    if (k_sem_take(&m_rx_sem, timeout)) {
+      return -EAGAIN;
+    }
+  }
+  return 0;
+}
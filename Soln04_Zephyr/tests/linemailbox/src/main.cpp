@@ -0,0 +1,137 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "linemailbox.h"
+
+// LineMailbox as used by the Soln04 reader/writer threads: lines are never
+// lost without being counted and come out in the order they went in.
+
+constexpr size_t kLineSlots = 4;
+constexpr size_t kLineSize = 32;
+using Mailbox = LineMailbox<kLineSlots, kLineSize>;
+
+static uint32_t line_seq(const Mailbox::Line *line) {
+  return strtoul(line->data + strlen("line "), nullptr, 10);
+}
+
+static int post_seq(Mailbox &mailbox, uint32_t seq) {
+  char text[kLineSize];
+  int len = snprintf(text, sizeof(text), "line %u\r", seq);
+  return mailbox.Post(text, len);
+}
+
+ZTEST(linemailbox, test_full_mailbox_drops_and_counts) {
+  static Mailbox mailbox;
+  constexpr uint32_t kSent = 10;
+
+  zassert_ok(mailbox.Init());
+  for (uint32_t i = 0; i < kSent; i++) {
+    int expected = i < kLineSlots ? 0 : -ENOMEM;
+    zassert_equal(post_seq(mailbox, i), expected, "post %u", i);
+  }
+  zassert_equal(mailbox.Posted(), kLineSlots);
+  zassert_equal(mailbox.Dropped(), kSent - kLineSlots);
+  zassert_equal(mailbox.Posted() + mailbox.Dropped(), kSent);
+  zassert_equal(mailbox.MaxUsed(), kLineSlots);
+
+  // the oldest lines were kept, the newest dropped
+  for (uint32_t i = 0; i < kLineSlots; i++) {
+    Mailbox::Line *line = mailbox.Fetch(K_NO_WAIT);
+    zassert_not_null(line);
+    zassert_equal(line_seq(line), i);
+    mailbox.Free(line);
+  }
+  zassert_is_null(mailbox.Fetch(K_NO_WAIT));
+
+  // freed slots are usable again
+  zassert_ok(post_seq(mailbox, kSent));
+  Mailbox::Line *line = mailbox.Fetch(K_NO_WAIT);
+  zassert_not_null(line);
+  zassert_equal(line_seq(line), kSent);
+  mailbox.Free(line);
+}
+
+ZTEST(linemailbox, test_long_line_is_truncated) {
+  static Mailbox mailbox;
+  char text[2 * kLineSize];
+
+  memset(text, 'x', sizeof(text));
+  zassert_ok(mailbox.Init());
+  zassert_ok(mailbox.Post(text, sizeof(text)));
+
+  Mailbox::Line *line = mailbox.Fetch(K_NO_WAIT);
+  zassert_not_null(line);
+  zassert_equal(line->len, kLineSize - 1);
+  zassert_equal(line->data[kLineSize - 1], '\0');
+  mailbox.Free(line);
+}
+
+// Stress: the reader posts bursts of 8 lines per tick, the writer takes one
+// line per tick, as the uart echo did in the old UART_STRESS build of main.
+constexpr uint32_t kStressLines = 2000;
+
+static Mailbox stress_mailbox;
+static volatile bool stress_done;
+static uint32_t stress_received;
+static uint32_t stress_out_of_order;
+
+K_THREAD_STACK_DEFINE(stack_writer, 2048);
+static k_thread writer_thread;
+
+static void writer(void *, void *, void *) {
+  int64_t last = -1;
+
+  while (true) {
+    Mailbox::Line *line = stress_mailbox.Fetch(K_MSEC(100));
+    if (!line) {
+      if (stress_done) {
+        return;
+      }
+      continue;
+    }
+    int64_t seq = line_seq(line);
+    if (seq <= last) {
+      stress_out_of_order++;
+    }
+    last = seq;
+    stress_received++;
+    stress_mailbox.Free(line);
+    k_sleep(K_TICKS(1));
+  }
+}
+
+ZTEST(linemailbox, test_stress_counts_and_order) {
+  zassert_ok(stress_mailbox.Init());
+  stress_done = false;
+
+  k_tid_t tid = k_thread_create(&writer_thread, stack_writer,
+                                K_THREAD_STACK_SIZEOF(stack_writer), writer,
+                                nullptr, nullptr, nullptr, K_PRIO_PREEMPT(1),
+                                0, K_NO_WAIT);
+
+  for (uint32_t i = 0; i < kStressLines; i++) {
+    post_seq(stress_mailbox, i);
+    if (i % 8 == 7) {
+      k_sleep(K_TICKS(1));
+    }
+  }
+  stress_done = true;
+  zassert_ok(k_thread_join(tid, K_SECONDS(10)));
+
+  uint32_t posted = stress_mailbox.Posted();
+  uint32_t dropped = stress_mailbox.Dropped();
+  TC_PRINT("sent %u, posted %u, dropped %u, max slots used %u/%zu\n",
+           kStressLines, posted, dropped, stress_mailbox.MaxUsed(),
+           kLineSlots);
+
+  zassert_equal(posted + dropped, kStressLines);
+  zassert_equal(stress_received, posted);
+  zassert_equal(stress_out_of_order, 0);
+  zassert_true(dropped > 0, "the writer never fell behind");
+}
+
+ZTEST_SUITE(linemailbox, NULL, NULL, NULL, NULL, NULL);
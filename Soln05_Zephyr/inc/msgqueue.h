@@ -0,0 +1,95 @@
+#ifndef MSGQUEUE_H
+#define MSGQUEUE_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <zephyr/kernel.h>
+
+// Typed wrapper over k_msgq. k_msgq moves messages with memcpy, so only
+// trivially copyable payloads are accepted: a std::string (or anything
+// owning heap memory) would be copied as a raw pointer and end up shared
+// between threads. Large payloads go through MsgPool below and the queue
+// carries the pointer only.
+template <typename T, size_t N> class MsgQueue {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "k_msgq copies messages with memcpy");
+
+  k_msgq m_queue;
+  alignas(T) char m_buffer[N * sizeof(T)];
+
+public:
+  constexpr static size_t kLength = N;
+
+  MsgQueue() = default;
+  void Init() { k_msgq_init(&m_queue, m_buffer, sizeof(T), N); }
+
+  int Put(const T &msg, k_timeout_t timeout = K_NO_WAIT) {
+    return k_msgq_put(&m_queue, &msg, timeout);
+  }
+
+  int Get(T &msg, k_timeout_t timeout = K_NO_WAIT) {
+    return k_msgq_get(&m_queue, &msg, timeout);
+  }
+
+  // Returns how many of msgs were queued, stops at the first full queue.
+  size_t Put(const T *msgs, size_t count, k_timeout_t timeout = K_NO_WAIT) {
+    size_t put = 0;
+    while (put < count && !k_msgq_put(&m_queue, &msgs[put], timeout)) {
+      put++;
+    }
+    return put;
+  }
+
+  // Drains up to max messages without blocking, returns how many.
+  size_t TryGetAll(T *msgs, size_t max) {
+    size_t got = 0;
+    while (got < max && !k_msgq_get(&m_queue, &msgs[got], K_NO_WAIT)) {
+      got++;
+    }
+    return got;
+  }
+
+  size_t Used() { return k_msgq_num_used_get(&m_queue); }
+  size_t Free() { return k_msgq_num_free_get(&m_queue); }
+  void Purge() { k_msgq_purge(&m_queue); }
+
+  // for K_POLL_TYPE_MSGQ_DATA_AVAILABLE events
+  k_msgq *Handle() { return &m_queue; }
+};
+
+// Fixed pool of T backed by a k_mem_slab: allocate, fill in place, send the
+// pointer through a MsgQueue<T *, N>, the receiver Free()s it. No heap and
+// no copy of the payload, T does not need to be trivially copyable.
+template <typename T, size_t N> class MsgPool {
+  // slab blocks must be a multiple of the pointer size and aligned to it
+  constexpr static size_t kAlign =
+      alignof(T) > sizeof(void *) ? alignof(T) : sizeof(void *);
+  constexpr static size_t kBlockSize = (sizeof(T) + kAlign - 1) & ~(kAlign - 1);
+
+  k_mem_slab m_slab;
+  alignas(kAlign) char m_storage[N * kBlockSize];
+
+public:
+  MsgPool() = default;
+  int Init() { return k_mem_slab_init(&m_slab, m_storage, kBlockSize, N); }
+
+  template <typename... Args> T *Alloc(k_timeout_t timeout, Args &&...args) {
+    void *block;
+    if (k_mem_slab_alloc(&m_slab, &block, timeout)) {
+      return nullptr;
+    }
+    return new (block) T{std::forward<Args>(args)...};
+  }
+
+  void Free(T *msg) {
+    msg->~T();
+    k_mem_slab_free(&m_slab, msg);
+  }
+
+  size_t Used() { return k_mem_slab_num_used_get(&m_slab); }
+};
+
+#endif // MSGQUEUE_H
@@ -1,13 +1,15 @@
 #include <atomic>
 #include <cstring>
 #include <iostream>
-#include <string>
+#include <string_view>
 
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 
+#include "command.h"
 #include "led.h"
+#include "msgqueue.h"
 #include "uartpolling.h"
 
 #define LED_DELAY_DEF (500U)
@@ -42,33 +44,24 @@ constexpr const device *uart_port = (DEVICE_DT_GET(DT_ALIAS(usercom0)));
 Led led{led_pin};
 
 UartPolling user_com_port{uart_port};
+k_poll_signal uart_rx_signal; // raised by the uart rx irq
 
 // Queues:
-using msg1_t = __attribute__((aligned(4))) uint32_t;
+using msg1_t = uint32_t;
+// trivially copyable: bmsg refers to a string literal, nothing is owned
 using msg2_t = struct msg2_st {
-  std::string bmsg;
+  std::string_view bmsg;
   uint32_t blinks;
-} __attribute__((aligned(4)));
+};
 constexpr size_t kQueueLength = 10;
-constexpr size_t kMsg1Size = sizeof(msg1_t);
-constexpr size_t kMsg2Size = sizeof(msg2_t);
 
-// k_msgq is a structure that maintains the respective buffer
-k_msgq msg1_queue_handle = {NULL};
-k_msgq msg2_queue_handle = {NULL};
-
-// Create a queue buffer with word alignment.
-char __aligned(4) msg1_buffer[kQueueLength * kMsg1Size];
-char __aligned(4) msg2_buffer[kQueueLength * kMsg2Size];
-
-// Static (Compile time) Queue creation: The param 4 -> __aligned(4)
-// K_MSGQ_DEFINE(msg1_queue_handle, kMsg1Size, kQueueLength, 4);
+MsgQueue<msg1_t, kQueueLength> msg1_queue;
+MsgQueue<msg2_t, kQueueLength> msg2_queue;
 
 static void led_blink_thread(void *param1, void *param2, void *param3) {
 
   static uint32_t led_blink_count = 0;
-  static msg2_t msg = {.bmsg = std::string("Blink count is "),
-                       .blinks = led_blink_count};
+  static msg2_t msg = {.bmsg = "Blink count is ", .blinks = led_blink_count};
   static msg1_t msg_buff = LED_DELAY_DEF;
 
   while (true) {
@@ -76,13 +69,11 @@ static void led_blink_thread(void *param1, void *param2, void *param3) {
     led_blink_count++;
     if (led_blink_count % 100 == 0) {
       msg.blinks = led_blink_count;
-      if (k_msgq_put(&msg2_queue_handle, reinterpret_cast<const void *>(&msg),
-                     K_NO_WAIT)) {
+      if (msg2_queue.Put(msg)) {
         LOG_ERR("%s: Error Sending Queue for msg2", __func__);
       }
     }
-    if (!k_msgq_get(&msg1_queue_handle, reinterpret_cast<void *>(&msg_buff),
-                    K_NO_WAIT)) {
+    if (!msg1_queue.Get(msg_buff)) {
       LOG_INF("%s: msg1 recived: update delay time: %d", __func__, msg_buff);
       led_blink_count = 0;
     }
@@ -90,75 +81,109 @@ static void led_blink_thread(void *param1, void *param2, void *param3) {
   }
 }
 
+// uart commands
+static int cmd_delay(const CommandArgs &args) {
+  msg1_t delay_time = args.value[1];
+
+  k_thread_suspend(thread_1_tid); // Immediate effect: Suspend the led task as
+                                  // it is currently blocked due to k_msleep()
+  // insert the delay
+  if (msg1_queue.Put(delay_time))
+    LOG_ERR("%s: Error sending msg1", __func__);
+
+  k_thread_resume(thread_1_tid); // Immediate effect: Start blinking with new
+                                 // delay time
+  return 0;
+}
+
+constexpr Command uart_commands[] = {
+    {"delay", cmd_delay, {ArgType::kUint}},
+};
+constexpr CommandTable uart_command_table{uart_commands};
+
 static void uart_read_thread(void *param1, void *param2, void *param3) {
-  int ret = 0;
   size_t index = 0;
   size_t read_buff_size = 100;
   unsigned char read_buff[read_buff_size] = {'0'};
 
+  // wake up on uart rx or on a blink report from the led thread only
+  k_poll_event events[] = {
+      K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_SIGNAL, K_POLL_MODE_NOTIFY_ONLY,
+                               &uart_rx_signal),
+      K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_MSGQ_DATA_AVAILABLE,
+                               K_POLL_MODE_NOTIFY_ONLY, msg2_queue.Handle())};
+
   while (true) {
+    k_poll(events, ARRAY_SIZE(events), K_FOREVER);
+
+    if (events[1].state == K_POLL_STATE_MSGQ_DATA_AVAILABLE) {
+      events[1].state = K_POLL_STATE_NOT_READY;
+      static msg2_t msgs[kQueueLength];
+      size_t count = msg2_queue.TryGetAll(msgs, ARRAY_SIZE(msgs));
+      for (size_t i = 0; i < count; i++) {
+        LOG_INF("%s: Message from msg2: %s %d", __func__, msgs[i].bmsg.data(),
+                msgs[i].blinks);
+      }
+    }
 
-    do {
-      if ((ret = user_com_port.Read(read_buff[index])) == 0) {
-        user_com_port.Write(read_buff[index++]);
-        if (index > read_buff_size - 1) {
-          index = read_buff_size - 1;
-          break;
-        }
+    if (events[0].state != K_POLL_STATE_SIGNALED) {
+      continue;
+    }
+    events[0].state = K_POLL_STATE_NOT_READY;
+
+    bool line_done = false;
+    while (!line_done && !user_com_port.Read(read_buff[index])) {
+      user_com_port.Write(read_buff[index]);
+      line_done = (read_buff[index] == '\r' || read_buff[index] == '\n');
+      index++;
+
+      if (index > read_buff_size - 1) {
+        index = read_buff_size - 1;
+        line_done = true;
       }
-      static msg2_t msg_buff;
-      if (!k_msgq_get(&msg2_queue_handle, &msg_buff, K_NO_WAIT))
-        LOG_INF("%s: Message from msg2: %s %d", __func__, msg_buff.bmsg.data(),
-                msg_buff.blinks);
-      k_msleep(2.5 * UART_DELAY);
-    } while (!ret);
-
-    read_buff[index] = '\0';
-    if (index) {
-      static int delay_time = 0;
-      const char *delay_str = "delay";
-      char delay_scanned[strlen(delay_str)] = {'0'};
-
-      sscanf(reinterpret_cast<const char *>(read_buff), "%s %d", delay_scanned,
-             &delay_time);
-
-      if (!strcmp(delay_str, delay_scanned)) {
-        k_thread_suspend(
-            thread_1_tid); // Immediate effect: Suspend the led task as it is
-                           // currently blocked due to k_msleep()
-        // insert the delay
-        if (k_msgq_put(&msg1_queue_handle,
-                       reinterpret_cast<const void *>(&delay_time), K_NO_WAIT))
-          LOG_ERR("%s: Error sending msg1", __func__);
-
-        k_thread_resume(thread_1_tid); // Immediate effect: Start blinking
-        // with
-        //  new delay time
+    }
+
+    if (line_done) {
+      read_buff[index] = '\0';
+      int ret =
+          uart_command_table.Dispatch(reinterpret_cast<char *>(read_buff));
+      if (ret == -EINVAL || ret == -E2BIG) {
+        LOG_ERR("%s: usage: delay <ms>", __func__);
       }
+      LOG_DBG("%s: byte-in to command-applied %u us", __func__,
+              k_cyc_to_us_floor32(k_cycle_get_32() - user_com_port.RxStamp()));
+      memset(read_buff, 0, index + 1); // clear the local buffer
+      index = 0;
     }
-    memset(read_buff, 0, index + 1); // clear the local buffer
-    index = 0;
-    k_msleep(UART_DELAY);
+    user_com_port.RearmRxSignal();
   }
 }
 
 extern "C" int main(void) {
 
   // Init the msgQ buffers
-  k_msgq_init(&msg1_queue_handle, msg1_buffer, kMsg1Size, kQueueLength);
-  k_msgq_init(&msg2_queue_handle, msg2_buffer, kMsg2Size, kQueueLength);
+  msg1_queue.Init();
+  msg2_queue.Init();
 
   if (led.Init()) {
     return 0;
   }
 
-  if (!user_com_port.Init()) {
-    LOG_ERR("uart config failed ...");
+  if (!user_com_port.IsReady()) {
+    LOG_ERR("uart port not found...");
     return 0;
   }
 
-  if (!user_com_port.IsReady()) {
-    LOG_ERR("uart port not found...");
+  // -ENOSYS: no runtime configuration, keep the devicetree settings
+  int err = user_com_port.Init();
+  if (err && err != -ENOSYS) {
+    LOG_ERR("uart config failed (%d)", err);
+    return 0;
+  }
+
+  k_poll_signal_init(&uart_rx_signal);
+  if (user_com_port.SetRxSignal(&uart_rx_signal)) {
+    LOG_ERR("uart rx irq setup failed...");
     return 0;
   }
 
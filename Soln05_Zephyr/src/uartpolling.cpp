@@ -5,9 +5,17 @@ UartPolling::UartPolling(const ptr_device_const &p_user_port = p_def_port,
     : m_port(p_user_port), config(user_config) {}
 
 UartPolling::UartPolling(const ptr_device_const &p_user_port = p_def_port)
-    : m_port(p_user_port) {}
+    : m_port(p_user_port), config(def_config) {}
 
-int UartPolling::Init() { return uart_configure(m_port, &config); }
+int UartPolling::Init() {
+#if CONFIG_UART_INTERRUPT_DRIVEN
+  k_mutex_init(&m_tx_lock);
+  k_sem_init(&m_tx_done, 0, 1);
+  // no irq api on this port: Write() stays on uart_poll_out()
+  m_irq_set = !uart_irq_callback_user_data_set(m_port, IrqHandler, this);
+#endif
+  return uart_configure(m_port, &config);
+}
 
 int UartPolling::IsReady() { return device_is_ready(m_port); }
 
@@ -20,6 +28,29 @@ void UartPolling::Write(const unsigned char &buffer) {
   uart_poll_out(m_port, buffer);
 }
 
+void UartPolling::Write(const uint8_t *buffer, size_t len) {
+#if CONFIG_UART_INTERRUPT_DRIVEN
+  if (m_irq_set && m_tx_irq && len && !k_is_in_isr()) {
+    // the tx irq fills the fifo in bursts, wait until all is queued
+    k_mutex_lock(&m_tx_lock, K_FOREVER);
+    m_tx_buf = buffer;
+    m_tx_len = len;
+    k_sem_reset(&m_tx_done);
+    uart_irq_tx_enable(m_port);
+    k_sem_take(&m_tx_done, K_FOREVER);
+    k_mutex_unlock(&m_tx_lock);
+    return;
+  }
+#endif
+  for (size_t i = 0; i < len; i++) {
+    uart_poll_out(m_port, buffer[i]);
+  }
+}
+
+void UartPolling::Write(std::string_view buffer) {
+  Write(reinterpret_cast<const uint8_t *>(buffer.data()), buffer.size());
+}
+
 void UartPolling::Write(const uint16_t &buffer) {
   uart_poll_out_u16(m_port, buffer);
 }
@@ -40,4 +71,52 @@ int UartPolling::Read(unsigned char &buffer) {
     buffer = '\0';
   }
   return ret;
-}
\ No newline at end of file
+}
+
+#if CONFIG_UART_INTERRUPT_DRIVEN
+void UartPolling::IrqHandler(const device *dev, void *user_data) {
+  UartPolling *self = static_cast<UartPolling *>(user_data);
+
+  if (!uart_irq_update(dev)) {
+    return;
+  }
+
+  if (self->m_rx_signal && uart_irq_rx_ready(dev)) {
+    // data stays in the fifo for Read(), only wake the reader
+    uart_irq_rx_disable(dev);
+    self->m_rx_stamp = k_cycle_get_32();
+    k_poll_signal_raise(self->m_rx_signal, 0);
+  }
+
+  if (uart_irq_tx_ready(dev)) {
+    if (self->m_tx_len) {
+      int sent = uart_fifo_fill(dev, self->m_tx_buf, self->m_tx_len);
+      if (sent > 0) {
+        self->m_tx_buf += sent;
+        self->m_tx_len -= sent;
+      }
+    }
+    if (!self->m_tx_len) {
+      uart_irq_tx_disable(dev);
+      k_sem_give(&self->m_tx_done);
+    }
+  }
+}
+
+int UartPolling::SetRxSignal(k_poll_signal *signal) {
+  m_rx_signal = signal;
+  int ret = uart_irq_callback_user_data_set(m_port, IrqHandler, this);
+  if (ret) {
+    return ret;
+  }
+  RearmRxSignal();
+  return 0;
+}
+
+void UartPolling::RearmRxSignal() {
+  k_poll_signal_reset(m_rx_signal);
+  // rx ready is level triggered: bytes that came in after the last Read()
+  // fire the irq again right away
+  uart_irq_rx_enable(m_port);
+}
+#endif
\ No newline at end of file
@@ -4,33 +4,111 @@
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/logging/log_instance.h>
+#include <zephyr/sys/atomic.h>
 
 struct led_instance {
   LOG_INSTANCE_PTR_DECLARE(log);
   uint32_t id;
+  // filled by LedTraceCount/LedTraceLog, read with Led::Changes()/Errors()
+  mutable atomic_t changes;
+  mutable atomic_t errors;
 };
 
 #define LED_LOGGER_DEFINE(_name)                                               \
   LOG_INSTANCE_REGISTER(led_instance, _name, CONFIG_LOG_DEFAULT_LEVEL)         \
   struct led_instance _name = {LOG_INSTANCE_PTR_INIT(log, led_instance, _name)};
 
-class Led {
+// Tracing policies for the Toggle/On/Off hot path, picked per Led instance:
+//   LedTraceNone  - compiles away
+//   LedTraceCount - atomic change/error counters in the led_instance
+//   LedTraceLog   - counters + LOG_INST_INF on every change (the old way)
+struct LedTraceNone {
+  static void Toggle(const led_instance &) {}
+  static void Switch(const led_instance &, bool) {}
+  static void Error(const led_instance &, int) {}
+};
+
+struct LedTraceCount {
+  static void Toggle(const led_instance &logger) {
+    atomic_inc(&logger.changes);
+  }
+  static void Switch(const led_instance &logger, bool) {
+    atomic_inc(&logger.changes);
+  }
+  static void Error(const led_instance &logger, int) {
+    atomic_inc(&logger.errors);
+  }
+};
+
+struct LedTraceLog {
+  static void Toggle(const led_instance &logger);
+  static void Switch(const led_instance &logger, bool on);
+  static void Error(const led_instance &logger, int err);
+};
+
+// default for Led<>: 0-> none; 1-> counters; 2-> log every change. Off by
+// default so release builds get the zero cost path; build with
+// -DLED_TRACE=2 (or use Led<LedTraceLog>) to log changes while debugging.
+#ifndef LED_TRACE
+#define LED_TRACE 0
+#endif
 
+#if LED_TRACE == 0
+using LedTraceDefault = LedTraceNone;
+#elif LED_TRACE == 1
+using LedTraceDefault = LedTraceCount;
+#else
+using LedTraceDefault = LedTraceLog;
+#endif
+
+// pin setup and logging of the cold paths, shared by all policies
+class LedBase {
+protected:
   constexpr static gpio_dt_spec m_def_pin =
       GPIO_DT_SPEC_GET(DT_ALIAS(led0), gpios);
 
   gpio_dt_spec m_pin;
 
-  const led_instance& m_logger;
+  const led_instance &m_logger;
+
+  LedBase(const gpio_dt_spec &user_pin, const led_instance &logger_instance);
 
 public:
-  Led(const gpio_dt_spec &user_pin, const led_instance &logger_instance);
   int Init();
   int DeInit();
-  int Toggle();
-  int On();
-  int Off();
+  uint32_t Changes() const { return atomic_get(&m_logger.changes); }
+  uint32_t Errors() const { return atomic_get(&m_logger.errors); }
+};
+
+template <typename Trace = LedTraceDefault> class Led : public LedBase {
+public:
+  Led(const gpio_dt_spec &user_pin, const led_instance &logger_instance)
+      : LedBase(user_pin, logger_instance) {}
+
+  int Toggle() {
+    Trace::Toggle(m_logger);
+    return Check(gpio_pin_toggle_dt(&m_pin));
+  }
+
+  int On() {
+    Trace::Switch(m_logger, true);
+    return Check(gpio_pin_set_dt(&m_pin, true));
+  }
+
+  int Off() {
+    Trace::Switch(m_logger, false);
+    return Check(gpio_pin_set_dt(&m_pin, false));
+  }
+
   ~Led() = default;
+
+private:
+  int Check(int ret) {
+    if (ret) {
+      Trace::Error(m_logger, ret);
+    }
+    return ret;
+  }
 };
 
-#endif // LED_H
\ No newline at end of file
+#endif // LED_H
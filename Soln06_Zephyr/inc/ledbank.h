@@ -0,0 +1,76 @@
+#ifndef LEDBANK_H
+#define LEDBANK_H
+
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/kernel.h>
+
+#include "led.h"
+
+// A frame for the whole bank, bit i addresses the i-th pin passed to the
+// constructor. A led in none of the masks keeps its state, on wins over
+// off and off over toggle.
+struct LedFrame {
+  uint32_t on;
+  uint32_t off;
+  uint32_t toggle;
+};
+
+// Drives many leds as one: pins are grouped by gpio port at construction
+// and a frame is applied with a single gpio_port_set_masked() per port, so
+// all leds of a port change together and the cost is one driver call per
+// port instead of one per led. Apply() is safe from ISR context.
+//
+// The bank keeps a shadow of the logical output level (toggle = shadow ^
+// mask), so its pins must not be driven through Led at the same time.
+class LedBank {
+public:
+  constexpr static size_t kMaxLeds = 32;
+  constexpr static size_t kMaxPorts = 4;
+
+private:
+  struct port_group {
+    const device *port;
+    gpio_port_pins_t mask;    // pins of the bank on this port
+    gpio_port_value_t shadow; // last logical value written
+  };
+
+  struct led_pin {
+    uint8_t group;
+    gpio_pin_t pin;
+  };
+
+  const gpio_dt_spec *m_pins;
+  size_t m_count;
+  led_pin m_leds[kMaxLeds];
+  port_group m_groups[kMaxPorts];
+  size_t m_group_count = 0;
+  bool m_too_many_ports = false; // pins span more than kMaxPorts ports
+  k_spinlock m_lock;
+
+  const led_instance &m_logger;
+
+  LedBank(const gpio_dt_spec *pins, size_t count,
+          const led_instance &logger_instance);
+
+public:
+  template <size_t N>
+  LedBank(const gpio_dt_spec (&pins)[N], const led_instance &logger_instance)
+      : LedBank(pins, N, logger_instance) {
+    static_assert(N <= kMaxLeds, "one bit per led in LedFrame");
+  }
+
+  int Init();
+  int DeInit();
+  int Apply(const LedFrame &frame);
+  int On(size_t led) { return Apply({.on = BIT(led), .off = 0, .toggle = 0}); }
+  int Off(size_t led) {
+    return Apply({.on = 0, .off = BIT(led), .toggle = 0});
+  }
+  int Toggle(size_t led) {
+    return Apply({.on = 0, .off = 0, .toggle = BIT(led)});
+  }
+  size_t Ports() const { return m_group_count; }
+  ~LedBank() = default;
+};
+
+#endif // LEDBANK_H
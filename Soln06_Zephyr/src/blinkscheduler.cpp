@@ -0,0 +1,137 @@
+#include "blinkscheduler.h"
+
+void BlinkScheduler::Init() {
+  k_timer_init(&m_timer, TimerExpiry, NULL);
+  k_timer_user_data_set(&m_timer, this);
+}
+
+int BlinkScheduler::Add(toggle_fn_t toggle, void *led, uint32_t period_ms) {
+  k_spinlock_key_t key = k_spin_lock(&m_lock);
+
+  if (m_count == kMaxBlinks) {
+    k_spin_unlock(&m_lock, key);
+    return -ENOMEM;
+  }
+  uint8_t id = m_count++;
+  m_entries[id] = {.toggle = toggle, .led = led, .period = 0, .deadline = 0};
+  k_spin_unlock(&m_lock, key);
+
+  SetRate(id, period_ms);
+  return id;
+}
+
+int BlinkScheduler::SetRate(int id, uint32_t period_ms) {
+  if (id < 0 || static_cast<size_t>(id) >= m_count) {
+    return -EINVAL;
+  }
+
+  k_spinlock_key_t key = k_spin_lock(&m_lock);
+  blink_entry &entry = m_entries[id];
+
+  if (entry.period) {
+    HeapRemove(id);
+  }
+  entry.period = k_ms_to_ticks_ceil64(period_ms);
+  if (entry.period) {
+    entry.deadline = k_uptime_ticks() + entry.period;
+    HeapInsert(id);
+  }
+  Rearm();
+  k_spin_unlock(&m_lock, key);
+  return 0;
+}
+
+uint32_t BlinkScheduler::Rate(int id) const {
+  if (id < 0 || static_cast<size_t>(id) >= m_count) {
+    return 0;
+  }
+  return k_ticks_to_ms_floor64(m_entries[id].period);
+}
+
+void BlinkScheduler::TimerExpiry(k_timer *timer) {
+  BlinkScheduler *self =
+      static_cast<BlinkScheduler *>(k_timer_user_data_get(timer));
+
+  k_spinlock_key_t key = k_spin_lock(&self->m_lock);
+  int64_t now = k_uptime_ticks();
+
+  while (self->m_heap_size) {
+    blink_entry &entry = self->m_entries[self->m_heap[0]];
+    if (entry.deadline > now) {
+      break;
+    }
+    entry.toggle(entry.led);
+    // fixed grid, no drift; skip ahead if we fell a whole period behind
+    entry.deadline += entry.period;
+    if (entry.deadline <= now) {
+      entry.deadline = now + entry.period;
+    }
+    self->SiftDown(0);
+  }
+  self->Rearm();
+  k_spin_unlock(&self->m_lock, key);
+}
+
+// called with m_lock held
+void BlinkScheduler::Rearm() {
+  if (!m_heap_size) {
+    k_timer_stop(&m_timer);
+    return;
+  }
+  k_timer_start(&m_timer,
+                K_TIMEOUT_ABS_TICKS(m_entries[m_heap[0]].deadline),
+                K_NO_WAIT);
+}
+
+bool BlinkScheduler::Earlier(size_t a, size_t b) const {
+  return m_entries[m_heap[a]].deadline < m_entries[m_heap[b]].deadline;
+}
+
+void BlinkScheduler::Swap(size_t a, size_t b) {
+  uint8_t tmp = m_heap[a];
+  m_heap[a] = m_heap[b];
+  m_heap[b] = tmp;
+  m_heap_pos[m_heap[a]] = a;
+  m_heap_pos[m_heap[b]] = b;
+}
+
+void BlinkScheduler::SiftUp(size_t slot) {
+  while (slot && Earlier(slot, (slot - 1) / 2)) {
+    Swap(slot, (slot - 1) / 2);
+    slot = (slot - 1) / 2;
+  }
+}
+
+void BlinkScheduler::SiftDown(size_t slot) {
+  while (true) {
+    size_t first = slot;
+    size_t left = 2 * slot + 1;
+    size_t right = left + 1;
+    if (left < m_heap_size && Earlier(left, first)) {
+      first = left;
+    }
+    if (right < m_heap_size && Earlier(right, first)) {
+      first = right;
+    }
+    if (first == slot) {
+      return;
+    }
+    Swap(slot, first);
+    slot = first;
+  }
+}
+
+void BlinkScheduler::HeapInsert(uint8_t id) {
+  m_heap[m_heap_size] = id;
+  m_heap_pos[id] = m_heap_size;
+  SiftUp(m_heap_size++);
+}
+
+void BlinkScheduler::HeapRemove(uint8_t id) {
+  size_t slot = m_heap_pos[id];
+  Swap(slot, --m_heap_size);
+  if (slot < m_heap_size) {
+    SiftUp(slot);
+    SiftDown(slot);
+  }
+}
@@ -5,11 +5,11 @@ LED_LOGGER_DEFINE(m_default_log_instance);
 
 LOG_LEVEL_SET(CONFIG_LOG_DEFAULT_LEVEL);
 
-Led::Led(const gpio_dt_spec &user_pin = m_def_pin,
-         const led_instance &logger_instance = m_default_log_instance)
+LedBase::LedBase(const gpio_dt_spec &user_pin = m_def_pin,
+                 const led_instance &logger_instance = m_default_log_instance)
     : m_pin(user_pin), m_logger(logger_instance) {}
 
-int Led::Init() {
+int LedBase::Init() {
   if (!gpio_is_ready_dt(&m_pin)) {
     LOG_INST_ERR(m_logger.log, "Not ready..");
     return -1;
@@ -25,22 +25,26 @@ int Led::Init() {
   return 0;
 }
 
-int Led::DeInit() {
+int LedBase::DeInit() {
   LOG_INST_INF(m_logger.log, "DeInitialized..");
   return gpio_pin_configure_dt(&m_pin, GPIO_DISCONNECTED);
 }
 
-int Led::Toggle() {
-  LOG_INST_INF(m_logger.log, "Toggle..");
-  return gpio_pin_toggle_dt(&m_pin);
+void LedTraceLog::Toggle(const led_instance &logger) {
+  atomic_inc(&logger.changes);
+  LOG_INST_INF(logger.log, "Toggle..");
 }
 
-int Led::On() {
-  LOG_INST_INF(m_logger.log, "Switching ON..");
-  return gpio_pin_set_dt(&m_pin, true);
+void LedTraceLog::Switch(const led_instance &logger, bool on) {
+  atomic_inc(&logger.changes);
+  if (on) {
+    LOG_INST_INF(logger.log, "Switching ON..");
+  } else {
+    LOG_INST_INF(logger.log, "Switching OFF..");
+  }
 }
 
-int Led::Off() {
-  LOG_INST_INF(m_logger.log, "Switching OFF..");
-  return gpio_pin_set_dt(&m_pin, false);
-}
\ No newline at end of file
+void LedTraceLog::Error(const led_instance &logger, int err) {
+  atomic_inc(&logger.errors);
+  LOG_INST_ERR(logger.log, "Error %d", err);
+}
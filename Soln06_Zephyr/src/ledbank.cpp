@@ -0,0 +1,104 @@
+#include "ledbank.h"
+#include <zephyr/logging/log.h>
+
+LedBank::LedBank(const gpio_dt_spec *pins, size_t count,
+                 const led_instance &logger_instance)
+    : m_pins(pins), m_count(count), m_logger(logger_instance) {
+
+  for (size_t i = 0; i < m_count; i++) {
+    size_t group = 0;
+    while (group < m_group_count && m_groups[group].port != pins[i].port) {
+      group++;
+    }
+    if (group == m_group_count) {
+      if (m_group_count == kMaxPorts) {
+        // no room for another port: keep the leds so far, Init() fails
+        m_count = i;
+        m_too_many_ports = true;
+        break;
+      }
+      m_groups[m_group_count++] = {.port = pins[i].port, .mask = 0,
+                                   .shadow = 0};
+    }
+    m_groups[group].mask |= BIT(pins[i].pin);
+    m_leds[i] = {.group = static_cast<uint8_t>(group), .pin = pins[i].pin};
+  }
+}
+
+int LedBank::Init() {
+  if (m_too_many_ports) {
+    LOG_INST_ERR(m_logger.log, "More than %u gpio ports..",
+                 (uint32_t)kMaxPorts);
+    return -ENOMEM;
+  }
+  for (size_t i = 0; i < m_count; i++) {
+    if (!gpio_is_ready_dt(&m_pins[i])) {
+      LOG_INST_ERR(m_logger.log, "Pin %u not ready..", (uint32_t)i);
+      return -1;
+    }
+    // sets the per pin active low inversion used by gpio_port_set_masked
+    error_t ret = gpio_pin_configure_dt(&m_pins[i], GPIO_OUTPUT_INACTIVE);
+    if (ret < 0) {
+      LOG_INST_ERR(m_logger.log, "Error configuring pin %u", (uint32_t)i);
+      return ret;
+    }
+  }
+  for (size_t group = 0; group < m_group_count; group++) {
+    m_groups[group].shadow = 0;
+  }
+  LOG_INST_INF(m_logger.log, "Initialized %u leds on %u ports..",
+               (uint32_t)m_count, (uint32_t)m_group_count);
+  return 0;
+}
+
+int LedBank::DeInit() {
+  LOG_INST_INF(m_logger.log, "DeInitialized..");
+  for (size_t i = 0; i < m_count; i++) {
+    gpio_pin_configure_dt(&m_pins[i], GPIO_DISCONNECTED);
+  }
+  return 0;
+}
+
+int LedBank::Apply(const LedFrame &frame) {
+  gpio_port_pins_t on[kMaxPorts] = {0};
+  gpio_port_pins_t off[kMaxPorts] = {0};
+  gpio_port_pins_t toggle[kMaxPorts] = {0};
+  uint32_t touched = (frame.on | frame.off | frame.toggle);
+  int ret = 0;
+
+  // led bits -> port bits, only for the leds named in the frame
+  while (touched) {
+    size_t i = __builtin_ctz(touched);
+    touched &= touched - 1;
+    if (i >= m_count) {
+      return -EINVAL;
+    }
+    gpio_port_pins_t bit = BIT(m_leds[i].pin);
+    uint8_t group = m_leds[i].group;
+    if (frame.on & BIT(i)) {
+      on[group] |= bit;
+    } else if (frame.off & BIT(i)) {
+      off[group] |= bit;
+    } else {
+      toggle[group] |= bit;
+    }
+  }
+
+  k_spinlock_key_t key = k_spin_lock(&m_lock);
+  for (size_t group = 0; group < m_group_count; group++) {
+    gpio_port_pins_t mask = on[group] | off[group] | toggle[group];
+    if (!mask) {
+      continue;
+    }
+    gpio_port_value_t value =
+        ((m_groups[group].shadow ^ toggle[group]) | on[group]) & ~off[group];
+    int err = gpio_port_set_masked(m_groups[group].port, mask, value);
+    if (err) {
+      ret = err;
+      continue;
+    }
+    m_groups[group].shadow = (m_groups[group].shadow & ~mask) | (value & mask);
+  }
+  k_spin_unlock(&m_lock, key);
+  return ret;
+}
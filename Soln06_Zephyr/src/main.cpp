@@ -2,13 +2,27 @@
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 
+#include "blinkscheduler.h"
 #include "led.h"
+#include "ledbank.h"
 
 #define LED_DELAY1_DEF (300U)
 #define LED_DELAY2_DEF (500U)
 #define LED_DELAY3_DEF (234U)
 #define UART_DELAY (100U)
 
+// LED_BANK: 0-> one Led object per pin; 1-> both leds driven as a LedBank
+#define LED_BANK 0
+
+// BLINK_SCHEDULER: 0-> one thread per blink rate; 1-> all blinks from one
+// k_timer (no blink threads or stacks)
+#define BLINK_SCHEDULER 1
+
+#if BLINK_SCHEDULER && LED_BANK
+#error "BlinkScheduler drives Led objects, set LED_BANK to 0"
+#endif
+
+#if !BLINK_SCHEDULER
 // Threads
 #if CONFIG_BOARD_ESP
 constexpr size_t kThreadStackSize = 4 * 1024;
@@ -37,6 +51,7 @@ constexpr int thread_2_prio = 10;
 static k_sem param_read_k_semaphore = {NULL};
 
 static k_mutex led_access_mutex = {NULL};
+#endif
 
 constexpr const gpio_dt_spec thread_led_pin =
     GPIO_DT_SPEC_GET(DT_ALIAS(userled0), gpios);
@@ -48,9 +63,21 @@ LOG_MODULE_REGISTER(main, CONFIG_LOG_DEFAULT_LEVEL);
 LED_LOGGER_DEFINE(userled0);
 LED_LOGGER_DEFINE(led0);
 
-Led thread_led{thread_led_pin, userled0};
+#if LED_BANK
+LED_LOGGER_DEFINE(ledbank0);
+
+constexpr gpio_dt_spec bank_pins[] = {thread_led_pin, main_led_pin};
+enum { kThreadLed = 0, kMainLed };
+LedBank led_bank{bank_pins, ledbank0};
+#else
+// thread_led blinks from three threads: count only, report from main
+Led<LedTraceCount> thread_led{thread_led_pin, userled0};
 Led main_led{main_led_pin, led0};
+#endif
 
+#if BLINK_SCHEDULER
+BlinkScheduler blink_scheduler;
+#else
 using led_task_parm_st = struct led_param {
   uint8_t task_no;
   uint32_t blink_rate;
@@ -68,13 +95,51 @@ static void led_blink_thread(void *param1, void *param2, void *param3) {
 
   while (true) {
     k_mutex_lock(&led_access_mutex, K_FOREVER);
+#if LED_BANK
+    led_bank.Toggle(kThreadLed);
+#else
     thread_led.Toggle();
+#endif
     LOG_INF("Blink count = %u", ++blink_count);
     k_mutex_unlock(&led_access_mutex);
     k_msleep(led_params.blink_rate);
   }
 }
+#endif
+
+#if BLINK_SCHEDULER
+extern "C" int main(void) {
+
+  if (thread_led.Init()) {
+    return 0;
+  }
+  if (main_led.Init()) {
+    return 0;
+  }
+
+  // the three blink threads and the main loop, as schedules on one timer
+  blink_scheduler.Init();
+  int thread_blink = blink_scheduler.Add(thread_led, LED_DELAY1_DEF);
+  blink_scheduler.Add(thread_led, LED_DELAY2_DEF);
+  blink_scheduler.Add(thread_led, LED_DELAY3_DEF);
+  blink_scheduler.Add(main_led, LED_DELAY1_DEF);
+
+  uint32_t rate = LED_DELAY1_DEF;
+
+  while (true) {
+    k_msleep(10 * LED_DELAY2_DEF);
+
+    // runtime rate change, no thread suspend/resume
+    rate = (rate == LED_DELAY1_DEF) ? LED_DELAY3_DEF : LED_DELAY1_DEF;
+    blink_scheduler.SetRate(thread_blink, rate);
+    LOG_INF("thread led rate: %u, changes: %u, errors: %u",
+            blink_scheduler.Rate(thread_blink), thread_led.Changes(),
+            thread_led.Errors());
+  }
 
+  return 0;
+}
+#else
 extern "C" int main(void) {
 
   led_task_parm_st led1_params = {.task_no = 1, .blink_rate = LED_DELAY1_DEF};
@@ -84,12 +149,18 @@ extern "C" int main(void) {
   k_sem_init(&param_read_k_semaphore, 1, 1); // Binary Semaphore
   k_mutex_init(&led_access_mutex);           // Mutex Init
 
+#if LED_BANK
+  if (led_bank.Init()) {
+    return 0;
+  }
+#else
   if (thread_led.Init()) {
     return 0;
   }
   if (main_led.Init()) {
     return 0;
   }
+#endif
   LOG_INF("Starting led Thread 0...");
 
   thread_0_tid = k_thread_create(
@@ -115,10 +186,20 @@ extern "C" int main(void) {
   uint32_t main_count = 0;
 
   while (true) {
+#if LED_BANK
+    led_bank.Toggle(kMainLed);
+#else
     main_led.Toggle();
+#endif
+#if LED_BANK
     LOG_INF("Blink Led: %u", ++main_count);
+#else
+    LOG_INF("Blink Led: %u, thread led changes: %u, errors: %u", ++main_count,
+            thread_led.Changes(), thread_led.Errors());
+#endif
     k_msleep(LED_DELAY1_DEF);
   }
 
   return 0;
 }
+#endif
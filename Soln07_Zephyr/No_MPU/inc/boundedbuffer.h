@@ -0,0 +1,253 @@
+#ifndef BOUNDEDBUFFER_H
+#define BOUNDEDBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/mutex.h>
+#include <zephyr/sys/sem.h>
+
+// Bounded producer/consumer buffer of N elements of T. The synchronisation
+// is a policy, all of them usable from user mode threads:
+//
+//   SemMutexPolicy  - the original scheme: counting sys_sem for free/used
+//                     slots and a sys_mutex around the ring indices
+//   LockFreePolicy  - MPMC ring with a sequence number per cell, producers
+//                     and consumers only contend on one CAS; blocking calls
+//                     sleep a tick and retry. Holds exactly N items, any N.
+//   PipePolicy      - a k_pipe does the copying and the blocking; the pipe
+//                     is a kernel object defined by the app (K_PIPE_DEFINE)
+//                     and passed to the constructor
+//
+// Put()/Get() return 0, or -EAGAIN when the timeout expired.
+
+template <typename T, size_t N> class SemMutexPolicy {
+  T m_buf[N];
+  size_t m_head = 0;
+  size_t m_tail = 0;
+  sys_sem m_free;
+  sys_sem m_used;
+  sys_mutex m_mutex;
+
+public:
+  void Init() {
+    sys_sem_init(&m_free, N, N);
+    sys_sem_init(&m_used, 0, N);
+    sys_mutex_init(&m_mutex);
+  }
+
+  int Put(const T &item, k_timeout_t timeout) {
+    if (sys_sem_take(&m_free, timeout)) {
+      return -EAGAIN;
+    }
+    sys_mutex_lock(&m_mutex, K_FOREVER);
+    m_buf[m_head] = item;
+    m_head = (m_head + 1) % N;
+    sys_mutex_unlock(&m_mutex);
+    sys_sem_give(&m_used);
+    return 0;
+  }
+
+  int Get(T &item, k_timeout_t timeout) {
+    if (sys_sem_take(&m_used, timeout)) {
+      return -EAGAIN;
+    }
+    sys_mutex_lock(&m_mutex, K_FOREVER);
+    item = m_buf[m_tail];
+    m_tail = (m_tail + 1) % N;
+    sys_mutex_unlock(&m_mutex);
+    sys_sem_give(&m_free);
+    return 0;
+  }
+
+  void Grant(k_tid_t) {}
+};
+
+template <typename T, size_t N> class LockFreePolicy {
+  static_assert(N > 0 && N < INT32_MAX, "bad buffer size");
+  // the sequence scheme needs a power of 2 number of cells, m_free keeps the
+  // capacity at N when N is not one
+  constexpr static size_t RoundUpPow2(size_t n) {
+    size_t pow2 = 1;
+    while (pow2 < n) {
+      pow2 <<= 1;
+    }
+    return pow2;
+  }
+  constexpr static uint32_t kCells = RoundUpPow2(N);
+  constexpr static uint32_t kMask = kCells - 1;
+
+  struct cell {
+    std::atomic<uint32_t> seq;
+    T data;
+  };
+
+  cell m_cells[kCells];
+  std::atomic<int32_t> m_free{N};
+  std::atomic<uint32_t> m_enqueue{0};
+  std::atomic<uint32_t> m_dequeue{0};
+
+  // retries op until it succeeds or timeout runs out. Sleeps a tick between
+  // tries: k_yield() would never let lower priority threads (logging, idle)
+  // run while a consumer waits on an empty ring.
+  template <typename Op> static int Retry(Op op, k_timeout_t timeout) {
+    k_timepoint_t end = sys_timepoint_calc(timeout);
+    while (!op()) {
+      if (sys_timepoint_expired(end)) {
+        return -EAGAIN;
+      }
+      k_sleep(K_TICKS(1));
+    }
+    return 0;
+  }
+
+public:
+  void Init() {
+    for (uint32_t i = 0; i < kCells; i++) {
+      m_cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+    m_free.store(N, std::memory_order_relaxed);
+    m_enqueue.store(0, std::memory_order_relaxed);
+    m_dequeue.store(0, std::memory_order_release);
+  }
+
+  bool TryPut(const T &item) {
+    // reserve one of the N slots first
+    int32_t free = m_free.load(std::memory_order_relaxed);
+    do {
+      if (free <= 0) {
+        return false; // full
+      }
+    } while (!m_free.compare_exchange_weak(free, free - 1,
+                                           std::memory_order_acquire,
+                                           std::memory_order_relaxed));
+
+    uint32_t pos = m_enqueue.load(std::memory_order_relaxed);
+    cell *c;
+    while (true) {
+      c = &m_cells[pos & kMask];
+      int32_t diff = static_cast<int32_t>(
+          c->seq.load(std::memory_order_acquire) - pos);
+      if (diff == 0) {
+        if (m_enqueue.compare_exchange_weak(pos, pos + 1,
+                                            std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        // a consumer is still reading the cell, give the slot back
+        m_free.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      } else {
+        pos = m_enqueue.load(std::memory_order_relaxed);
+      }
+    }
+    c->data = item;
+    c->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool TryGet(T &item) {
+    uint32_t pos = m_dequeue.load(std::memory_order_relaxed);
+    cell *c;
+    while (true) {
+      c = &m_cells[pos & kMask];
+      int32_t diff = static_cast<int32_t>(
+          c->seq.load(std::memory_order_acquire) - (pos + 1));
+      if (diff == 0) {
+        if (m_dequeue.compare_exchange_weak(pos, pos + 1,
+                                            std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false; // empty
+      } else {
+        pos = m_dequeue.load(std::memory_order_relaxed);
+      }
+    }
+    item = c->data;
+    c->seq.store(pos + kMask + 1, std::memory_order_release);
+    m_free.fetch_add(1, std::memory_order_release);
+    return true;
+  }
+
+  int Put(const T &item, k_timeout_t timeout) {
+    return Retry([&] { return TryPut(item); }, timeout);
+  }
+
+  int Get(T &item, k_timeout_t timeout) {
+    return Retry([&] { return TryGet(item); }, timeout);
+  }
+
+  void Grant(k_tid_t) {}
+};
+
+template <typename T, size_t N> class PipePolicy {
+  k_pipe &m_pipe; // K_PIPE_DEFINE(name, N * sizeof(T), 4)
+
+public:
+  PipePolicy(k_pipe &pipe) : m_pipe(pipe) {}
+
+  void Init() {}
+
+  int Put(const T &item, k_timeout_t timeout) {
+    size_t written;
+    // min_xfer == size: a T goes in whole or not at all
+    if (k_pipe_put(&m_pipe, &item, sizeof(T), &written, sizeof(T), timeout)) {
+      return -EAGAIN;
+    }
+    return 0;
+  }
+
+  int Get(T &item, k_timeout_t timeout) {
+    size_t read;
+    if (k_pipe_get(&m_pipe, &item, sizeof(T), &read, sizeof(T), timeout)) {
+      return -EAGAIN;
+    }
+    return 0;
+  }
+
+  // user mode threads need access to the pipe kernel object
+  void Grant(k_tid_t thread) {
+#if CONFIG_USERSPACE
+    k_object_access_grant(&m_pipe, thread);
+#else
+    ARG_UNUSED(thread);
+#endif
+  }
+};
+
+template <typename T, size_t N, template <typename, size_t> class Policy>
+class BoundedBuffer {
+  Policy<T, N> m_policy;
+
+public:
+  constexpr static size_t kSize = N;
+
+  template <typename... Args>
+  BoundedBuffer(Args &&...args) : m_policy(std::forward<Args>(args)...) {}
+
+  void Init() { m_policy.Init(); }
+  int Put(const T &item, k_timeout_t timeout = K_FOREVER) {
+    return m_policy.Put(item, timeout);
+  }
+  int Get(T &item, k_timeout_t timeout = K_FOREVER) {
+    return m_policy.Get(item, timeout);
+  }
+  // call before starting a user mode thread that uses the buffer
+  void Grant(k_tid_t thread) { m_policy.Grant(thread); }
+};
+
+// Policy chosen in Kconfig (APP_BOUNDED_BUFFER_POLICY)
+#if CONFIG_APP_BOUNDED_BUFFER_LOCK_FREE
+template <typename T, size_t N> using AppBufferPolicy = LockFreePolicy<T, N>;
+#elif CONFIG_APP_BOUNDED_BUFFER_PIPE
+template <typename T, size_t N> using AppBufferPolicy = PipePolicy<T, N>;
+#define APP_BOUNDED_BUFFER_NEEDS_PIPE 1
+#else
+template <typename T, size_t N> using AppBufferPolicy = SemMutexPolicy<T, N>;
+#endif
+
+#endif // BOUNDEDBUFFER_H
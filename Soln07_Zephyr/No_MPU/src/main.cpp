@@ -14,6 +14,9 @@
 #include <zephyr/sys/mutex.h>
 #include <zephyr/sys/sem.h>
 
+#include "boundedbuffer.h"
+#include "stackwatch.h"
+
 #define LED_DELAY1_DEF (300U)
 #define LED_DELAY2_DEF (500U)
 #define LED_DELAY3_DEF (234U)
@@ -21,22 +24,23 @@
 
 LOG_MODULE_REGISTER(main, CONFIG_LOG_DEFAULT_LEVEL);
 
-enum { BUF_SIZE = 5 };                   // Size of buffer array
 static const uint8_t num_prod_tasks = 5; // Number of producer tasks
 static const uint8_t num_cons_tasks = 2; // Number of consumer tasks
+// Items queued before producers block: one per consumer, as the original
+// free slot semaphore (initialised to num_cons_tasks) allowed
+static const uint8_t buf_slots = num_cons_tasks;
 static const uint8_t num_writes = 3; // Num times each producer writes to buf
 
 // Globals
-static uint8_t buf[BUF_SIZE]; // Shared buffer
-static uint8_t head = 0;      // Writing index to buffer
-static uint8_t tail = 0;      // Reading index to buffer
-static sys_sem bin_sem;       // Waits for parameter to be read
+static sys_sem bin_sem; // Waits for parameter to be read
 
-static sys_sem
-    bin_sem1; // Waits for new produced buff element, in consumer task
-static sys_sem
-    bin_sem2; // Waits for the buff element to be consumed, in producer task
-static sys_mutex mutex; // To access the shared buffer
+// Shared buffer, synchronisation picked in Kconfig
+#if APP_BOUNDED_BUFFER_NEEDS_PIPE
+K_PIPE_DEFINE(buf_pipe, buf_slots * sizeof(uint8_t), 4);
+static BoundedBuffer<uint8_t, buf_slots, AppBufferPolicy> buf{buf_pipe};
+#else
+static BoundedBuffer<uint8_t, buf_slots, AppBufferPolicy> buf;
+#endif
 
 // producer:
 void producer(void *param1, void *param2, void *param3);
@@ -50,6 +54,16 @@ constexpr size_t kThreadStackSize = 4 * 1024;
 constexpr size_t kThreadStackSize = 2 * 1024;
 #endif
 
+// per thread group sizes from Kconfig (see stackwatch.h), 0 = default
+constexpr size_t StackSize(size_t configured) {
+  return configured ? configured : kThreadStackSize;
+}
+constexpr size_t kUserStackSize = StackSize(CONFIG_APP_STACK_SIZE_USER);
+constexpr size_t kProducerStackSize =
+    StackSize(CONFIG_APP_STACK_SIZE_PRODUCER);
+constexpr size_t kConsumerStackSize =
+    StackSize(CONFIG_APP_STACK_SIZE_CONSUMER);
+
 static k_thread thread_consumer[num_cons_tasks];
 static k_thread thread_producer[num_prod_tasks];
 static k_thread user_thread;
@@ -58,16 +72,16 @@ static k_tid_t thread_consumer_tid[num_cons_tasks];
 static k_tid_t thread_producer_tid[num_prod_tasks];
 static k_tid_t user_thread_tid;
 
-K_THREAD_STACK_DEFINE(stack_user_thread, kThreadStackSize);
+K_THREAD_STACK_DEFINE(stack_user_thread, kUserStackSize);
 
-K_THREAD_STACK_DEFINE(stack_thread_consumer0, kThreadStackSize);
-K_THREAD_STACK_DEFINE(stack_thread_consumer1, kThreadStackSize);
+K_THREAD_STACK_DEFINE(stack_thread_consumer0, kConsumerStackSize);
+K_THREAD_STACK_DEFINE(stack_thread_consumer1, kConsumerStackSize);
 
-K_THREAD_STACK_DEFINE(stack_thread_producer0, kThreadStackSize);
-K_THREAD_STACK_DEFINE(stack_thread_producer1, kThreadStackSize);
-K_THREAD_STACK_DEFINE(stack_thread_producer2, kThreadStackSize);
-K_THREAD_STACK_DEFINE(stack_thread_producer3, kThreadStackSize);
-K_THREAD_STACK_DEFINE(stack_thread_producer4, kThreadStackSize);
+K_THREAD_STACK_DEFINE(stack_thread_producer0, kProducerStackSize);
+K_THREAD_STACK_DEFINE(stack_thread_producer1, kProducerStackSize);
+K_THREAD_STACK_DEFINE(stack_thread_producer2, kProducerStackSize);
+K_THREAD_STACK_DEFINE(stack_thread_producer3, kProducerStackSize);
+K_THREAD_STACK_DEFINE(stack_thread_producer4, kProducerStackSize);
 
 k_thread_stack_t *stack_thread_consumer_ptr[num_cons_tasks] = {
     stack_thread_consumer0, stack_thread_consumer1};
@@ -77,6 +91,14 @@ k_thread_stack_t *stack_thread_producer_ptr[num_prod_tasks] = {
 
 constexpr int thread_priority = 10;
 
+#if CONFIG_APP_STACK_WATCH
+static StackWatch stack_watch;
+static const char *const producer_names[num_prod_tasks] = {
+    "producer[0]", "producer[1]", "producer[2]", "producer[3]", "producer[4]"};
+static const char *const consumer_names[num_cons_tasks] = {"consumer[0]",
+                                                           "consumer[1]"};
+#endif
+
 //*****************************************************************************
 // Tasks
 
@@ -91,15 +113,8 @@ void producer(void *param1, void *param2, void *param3) {
 
   // Fill shared buffer with task number
   for (uint8_t i = 0; i < num_writes; i++) {
-    sys_sem_take(&bin_sem2, K_FOREVER); // Empty buffer?
-    // Critical section (accessing shared buffer)
-    sys_mutex_lock(&mutex, K_FOREVER); // Take muex lock to access buffer
     LOG_INF("producer thread[%d] %d", num, num);
-    buf[head] = num;
-    head = (head + 1) % BUF_SIZE;
-    sys_mutex_unlock(&mutex); // Release mutex lock of buffer
-    sys_sem_give(
-        &bin_sem1); // Signal the consumer that new queue item is available
+    buf.Put(num); // waits for a free slot
 
     k_msleep(1);
   }
@@ -116,17 +131,8 @@ void consumer(void *param1, void *param2, void *param3) {
   // Read from buffer
   while (1) {
 
-    // Critical section (accessing shared buffer and Serial)
-    sys_sem_take(&bin_sem1,
-                 K_FOREVER); // wait till new buff is produced in the queue
-
-    sys_mutex_lock(&mutex,
-                   K_FOREVER); // mutex to access the shared buff: acquire lock
-    val = buf[tail];
-    tail = (tail + 1) % BUF_SIZE;
+    buf.Get(val); // wait till new buff is produced in the queue
     LOG_INF("consumer thread[%d] %d", num, val);
-    sys_mutex_unlock(&mutex); // mutex to access the shared buff: release lock
-    sys_sem_give(&bin_sem2);  // signal the buff value consumption
     k_msleep(1);
   }
 }
@@ -135,19 +141,19 @@ void user_thread_init(void *param1, void *param2, void *param3) {
 
   // Create mutexes and semaphores before starting tasks
   sys_sem_init(&bin_sem, 0, 1);
-  sys_sem_init(&bin_sem1, 0, num_prod_tasks); // incrementing semaphore
-  sys_sem_init(&bin_sem2, num_cons_tasks,
-               num_cons_tasks); // decrementing semaphore
-  sys_mutex_init(&mutex);
+  buf.Init();
 
   k_msleep(10); // To avoud dropping of log messages
   // Start producer tasks (wait for each to read argument)
   for (uint8_t i = 0; i < num_prod_tasks; i++) {
     thread_producer_tid[i] =
         k_thread_create(&thread_producer[i], stack_thread_producer_ptr[i],
-                        K_THREAD_STACK_SIZEOF(stack_thread_producer_ptr[i]),
+                        K_THREAD_STACK_SIZEOF(stack_thread_producer0),
                         producer, (void *)&i, nullptr, nullptr, thread_priority,
                         K_INHERIT_PERMS, K_NO_WAIT);
+#if CONFIG_APP_STACK_WATCH
+    stack_watch.Watch(&thread_producer[i], producer_names[i], "PRODUCER");
+#endif
 
     sys_sem_take(&bin_sem, K_FOREVER);
   }
@@ -155,27 +161,155 @@ void user_thread_init(void *param1, void *param2, void *param3) {
   for (uint8_t i = 0; i < num_cons_tasks; i++) {
     thread_consumer_tid[i] =
         k_thread_create(&thread_consumer[i], stack_thread_consumer_ptr[i],
-                        K_THREAD_STACK_SIZEOF(stack_thread_consumer_ptr[i]),
+                        K_THREAD_STACK_SIZEOF(stack_thread_consumer0),
                         consumer, (void *)&i, nullptr, nullptr, thread_priority,
                         K_INHERIT_PERMS, K_NO_WAIT);
+#if CONFIG_APP_STACK_WATCH
+    stack_watch.Watch(&thread_consumer[i], consumer_names[i], "CONSUMER");
+#endif
     sys_sem_take(&bin_sem, K_FOREVER);
   }
 
   LOG_INF("All tasks created");
 }
 
+#if CONFIG_APP_BOUNDED_BUFFER_BENCH
+//*****************************************************************************
+// Benchmark: producers push k_cycle_get_32() stamps as fast as they can,
+// consumers pop them and keep the put -> get latency. Reuses the challenge
+// threads and stacks, so it scales up to num_prod_tasks x num_cons_tasks.
+
+constexpr size_t kBenchBufSize = 16;
+constexpr uint32_t kBenchItems = 20000; // per run, split over the producers
+
+#if APP_BOUNDED_BUFFER_NEEDS_PIPE
+K_PIPE_DEFINE(bench_pipe, kBenchBufSize * sizeof(uint32_t), 4);
+static BoundedBuffer<uint32_t, kBenchBufSize, AppBufferPolicy> bench_buf{
+    bench_pipe};
+#else
+static BoundedBuffer<uint32_t, kBenchBufSize, AppBufferPolicy> bench_buf;
+#endif
+
+static std::atomic<uint32_t> bench_consumed;
+static uint32_t bench_total;
+static uint32_t bench_per_producer;
+static uint64_t bench_lat_sum[num_cons_tasks];
+static uint32_t bench_lat_max[num_cons_tasks];
+
+static void bench_producer(void *param1, void *param2, void *param3) {
+  for (uint32_t i = 0; i < bench_per_producer; i++) {
+    bench_buf.Put(k_cycle_get_32());
+  }
+}
+
+static void bench_consumer(void *param1, void *param2, void *param3) {
+  size_t num = (size_t)param1;
+  uint32_t stamp;
+
+  while (bench_consumed.load() < bench_total) {
+    if (bench_buf.Get(stamp, K_MSEC(10))) {
+      continue;
+    }
+    uint32_t latency = k_cycle_get_32() - stamp;
+    bench_lat_sum[num] += latency;
+    bench_lat_max[num] = MAX(bench_lat_max[num], latency);
+    bench_consumed.fetch_add(1);
+  }
+}
+
+static void bench_run(uint8_t producers, uint8_t consumers) {
+  bench_per_producer = kBenchItems / producers;
+  bench_total = bench_per_producer * producers;
+  bench_consumed.store(0);
+  for (uint8_t i = 0; i < consumers; i++) {
+    bench_lat_sum[i] = 0;
+    bench_lat_max[i] = 0;
+  }
+
+  uint32_t start = k_cycle_get_32();
+  for (uint8_t i = 0; i < consumers; i++) {
+    thread_consumer_tid[i] = k_thread_create(
+        &thread_consumer[i], stack_thread_consumer_ptr[i],
+        K_THREAD_STACK_SIZEOF(stack_thread_consumer0), bench_consumer,
+        (void *)(size_t)i, nullptr, nullptr, thread_priority, 0, K_NO_WAIT);
+#if CONFIG_APP_STACK_WATCH
+    stack_watch.Watch(&thread_consumer[i], consumer_names[i], "CONSUMER");
+#endif
+  }
+  for (uint8_t i = 0; i < producers; i++) {
+    thread_producer_tid[i] = k_thread_create(
+        &thread_producer[i], stack_thread_producer_ptr[i],
+        K_THREAD_STACK_SIZEOF(stack_thread_producer0), bench_producer,
+        nullptr, nullptr, nullptr, thread_priority, 0, K_NO_WAIT);
+#if CONFIG_APP_STACK_WATCH
+    stack_watch.Watch(&thread_producer[i], producer_names[i], "PRODUCER");
+#endif
+  }
+  for (uint8_t i = 0; i < producers; i++) {
+    k_thread_join(thread_producer_tid[i], K_FOREVER);
+  }
+  for (uint8_t i = 0; i < consumers; i++) {
+    k_thread_join(thread_consumer_tid[i], K_FOREVER);
+  }
+  uint32_t cycles = k_cycle_get_32() - start;
+#if CONFIG_APP_STACK_WATCH
+  stack_watch.Sample(); // the next run recreates the threads
+#endif
+
+  uint64_t lat_sum = 0;
+  uint32_t lat_max = 0;
+  for (uint8_t i = 0; i < consumers; i++) {
+    lat_sum += bench_lat_sum[i];
+    lat_max = MAX(lat_max, bench_lat_max[i]);
+  }
+  uint32_t items_per_sec =
+      cycles ? (uint64_t)bench_total * sys_clock_hw_cycles_per_sec() / cycles
+             : 0;
+  LOG_INF("bench %up/%uc: %u items/s, latency avg %u max %u cycles",
+          producers, consumers, items_per_sec,
+          (uint32_t)(lat_sum / bench_total), lat_max);
+}
+
+static void bench_thread(void *param1, void *param2, void *param3) {
+  const uint8_t runs[][2] = {{1, 1}, {2, 1}, {5, 1}, {1, 2}, {5, 2}};
+
+  bench_buf.Init();
+  k_msleep(10); // To avoud dropping of log messages
+  for (const auto &run : runs) {
+    bench_run(run[0], run[1]);
+    k_msleep(10);
+  }
+  LOG_INF("bench done");
+}
+#endif
+
 extern "C" int main(void) {
 
   LOG_INF("---Zephyr RTOS Semaphore Alternate Solution---");
+#if CONFIG_APP_BOUNDED_BUFFER_BENCH
+  user_thread_tid = k_thread_create(
+      &user_thread, stack_user_thread, K_THREAD_STACK_SIZEOF(stack_user_thread),
+      bench_thread, nullptr, nullptr, nullptr, thread_priority,
+      K_INHERIT_PERMS, K_NO_WAIT);
+#else
   // user_thread: Create mutexes and semaphores before starting tasks
   user_thread_tid = k_thread_create(
       &user_thread, stack_user_thread, K_THREAD_STACK_SIZEOF(stack_user_thread),
       user_thread_init, nullptr, nullptr, nullptr, thread_priority,
       K_INHERIT_PERMS, K_NO_WAIT);
+#endif
+#if CONFIG_APP_STACK_WATCH
+  stack_watch.Watch(&user_thread, "user_thread", "USER");
+#endif
 
   while (true) {
+#if CONFIG_APP_STACK_WATCH
+    k_msleep(CONFIG_APP_STACK_WATCH_PERIOD_MS);
+    stack_watch.Report();
+#else
     // Do nothing but allow yielding to lower-priority tasks
     k_msleep(1000U);
+#endif
   }
 
   return 0;
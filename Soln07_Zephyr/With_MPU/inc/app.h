@@ -6,6 +6,23 @@
 
 void userspace_thread_init(void *p1, void *p2, void *p3);
 
+// Threads
+#if CONFIG_BOARD_ESP
+constexpr size_t kThreadStackSize = 4 * 1024;
+#else
+constexpr size_t kThreadStackSize = 2 * 1024;
+#endif
+
+// per thread group sizes from Kconfig (see stackwatch.h), 0 = default
+constexpr size_t StackSize(size_t configured) {
+  return configured ? configured : kThreadStackSize;
+}
+
+#if CONFIG_APP_STACK_WATCH
+#include "stackwatch.h"
+extern StackWatch stack_watch; // kernel memory, used by supervisor threads
+#endif
+
 extern struct k_mem_partition user_partition;
 #define USER_DATA	K_APP_DMEM(user_partition)
 #define USER_BSS	K_APP_BMEM(user_partition)
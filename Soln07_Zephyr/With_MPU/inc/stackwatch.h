@@ -0,0 +1,57 @@
+#ifndef STACKWATCH_H
+#define STACKWATCH_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <zephyr/kernel.h>
+
+// Stack high water marks of the app threads. Threads are registered with a
+// group name (threads of one group share a stack size, e.g. all producers),
+// the stack size is read from the thread (stack_info). Report() logs
+// used/free per thread and a suggested size per group as a Kconfig line:
+//
+//   stack producer[0]: size 2048 used 412 free 1636
+//   stack suggest CONFIG_APP_STACK_SIZE_PRODUCER=576
+//
+// Copy the suggestion lines into stack_sizes.conf and rebuild with
+// -DEXTRA_CONF_FILE=stack_sizes.conf to apply them. Needs CONFIG_INIT_STACKS
+// and CONFIG_THREAD_STACK_INFO (selected by CONFIG_APP_STACK_WATCH).
+class StackWatch {
+public:
+  constexpr static size_t kMaxThreads = 12;
+  constexpr static size_t kMaxGroups = 4;
+  // suggestion = used + used / 4, at least kMinStack, rounded to kAlign,
+  // then to the stack object size of the arch (K_THREAD_STACK_LEN)
+  constexpr static size_t kMinStack = 512;
+  constexpr static size_t kAlign = 64;
+
+private:
+  using entry_t = struct entry_st {
+    const k_thread *thread;
+    const char *name;
+    uint8_t group;
+    size_t size;
+    size_t max_used; // survives the thread exiting and being recreated
+  };
+
+  entry_t m_threads[kMaxThreads];
+  size_t m_count = 0;
+  const char *m_groups[kMaxGroups];
+  size_t m_group_count = 0;
+  k_spinlock m_lock;
+
+  static size_t Suggest(size_t used);
+
+public:
+  // group is the Kconfig suffix, e.g. "PRODUCER"; name is for the report.
+  // Registering the same k_thread again (thread recreated) updates it.
+  int Watch(const k_thread *thread, const char *name, const char *group);
+  // refreshes every high water mark, call it before a thread is recreated
+  void Sample();
+  void Report();
+
+  ~StackWatch() = default;
+};
+
+#endif // STACKWATCH_H
@@ -5,6 +5,7 @@
 #include <zephyr/sys/sem.h>
 
 #include "app.h"
+#include "boundedbuffer.h"
 
 #define LED_DELAY1_DEF (300U)
 #define LED_DELAY2_DEF (500U)
@@ -22,36 +23,31 @@ K_APPMEM_PARTITION_DEFINE(
 
 static struct k_mem_domain user_domain;
 
-#define BUF_SIZE 5                          // Size of buffer array
 USER_DATA const uint8_t num_prod_tasks = 5; // Number of producer tasks
 USER_DATA const uint8_t num_cons_tasks = 2; // Number of consumer tasks
+// Items queued before producers block: one per consumer, as the original
+// free slot semaphore (initialised to num_cons_tasks) allowed
+constexpr uint8_t buf_slots = num_cons_tasks;
 USER_DATA const uint8_t num_writes = 3; // Num times each producer writes to buf
 
 // Userspace Application Globals
-USER_BSS uint8_t buf[BUF_SIZE];                     // Shared buffer
-USER_DATA uint8_t head = 0;                         // Writing index to buffer
-USER_DATA uint8_t tail = 0;                         // Reading index to buffer
 USER_BSS int8_t parameter1, parameter2, parameter3; // send params to tasks
 USER_BSS sys_sem bin_sem; // Waits for parameter to be read
 
-USER_BSS sys_sem
-    bin_sem1; // Waits for new produced buff element, in consumer task
-USER_BSS sys_sem
-    bin_sem2; // Waits for the buff element to be consumed, in producer task
-USER_BSS sys_mutex mutex; // To access the shared buffer
+// Shared buffer, synchronisation picked in Kconfig. Lives in the user
+// partition, the k_pipe variant also needs Grant() per thread.
+#if APP_BOUNDED_BUFFER_NEEDS_PIPE
+K_PIPE_DEFINE(buf_pipe, buf_slots * sizeof(uint8_t), 4);
+USER_DATA BoundedBuffer<uint8_t, buf_slots, AppBufferPolicy> buf{buf_pipe};
+#else
+USER_BSS BoundedBuffer<uint8_t, buf_slots, AppBufferPolicy> buf;
+#endif
 
 // producer:
 static void app_thread_producer(void *param1, void *param2, void *param3);
 // consumer:
 static void app_thread_consumer(void *param1, void *param2, void *param3);
 
-// Threads
-#if CONFIG_BOARD_ESP
-constexpr size_t kThreadStackSize = 4 * 1024;
-#else
-constexpr size_t kThreadStackSize = 2 * 1024;
-#endif
-
 // TIDs
 static k_tid_t app_consumer_thread_tid[num_cons_tasks];
 static k_tid_t app_producer_thread_tid[num_prod_tasks];
@@ -64,19 +60,33 @@ static k_thread app_producer_thread[num_prod_tasks];
 
 // Thread Stacks
 
-K_THREAD_STACK_DEFINE(stack_app_init_thread, kThreadStackSize);
+constexpr size_t kInitStackSize = StackSize(CONFIG_APP_STACK_SIZE_INIT);
+constexpr size_t kProducerStackSize =
+    StackSize(CONFIG_APP_STACK_SIZE_PRODUCER);
+constexpr size_t kConsumerStackSize =
+    StackSize(CONFIG_APP_STACK_SIZE_CONSUMER);
+
+K_THREAD_STACK_DEFINE(stack_app_init_thread, kInitStackSize);
 
-K_THREAD_STACK_DEFINE(stack_app_consumer_thread0, kThreadStackSize);
-K_THREAD_STACK_DEFINE(stack_app_consumer_thread1, kThreadStackSize);
+K_THREAD_STACK_DEFINE(stack_app_consumer_thread0, kConsumerStackSize);
+K_THREAD_STACK_DEFINE(stack_app_consumer_thread1, kConsumerStackSize);
 
-K_THREAD_STACK_DEFINE(stack_app_producer_thread0, kThreadStackSize);
-K_THREAD_STACK_DEFINE(stack_app_producer_thread1, kThreadStackSize);
-K_THREAD_STACK_DEFINE(stack_app_producer_thread2, kThreadStackSize);
-K_THREAD_STACK_DEFINE(stack_app_producer_thread3, kThreadStackSize);
-K_THREAD_STACK_DEFINE(stack_app_producer_thread4, kThreadStackSize);
+K_THREAD_STACK_DEFINE(stack_app_producer_thread0, kProducerStackSize);
+K_THREAD_STACK_DEFINE(stack_app_producer_thread1, kProducerStackSize);
+K_THREAD_STACK_DEFINE(stack_app_producer_thread2, kProducerStackSize);
+K_THREAD_STACK_DEFINE(stack_app_producer_thread3, kProducerStackSize);
+K_THREAD_STACK_DEFINE(stack_app_producer_thread4, kProducerStackSize);
 
 constexpr static int thread_priority = K_PRIO_PREEMPT(-1);
 
+#if CONFIG_APP_STACK_WATCH
+StackWatch stack_watch;
+static const char *const producer_names[num_prod_tasks] = {
+    "producer[0]", "producer[1]", "producer[2]", "producer[3]", "producer[4]"};
+static const char *const consumer_names[num_cons_tasks] = {"consumer[0]",
+                                                           "consumer[1]"};
+#endif
+
 // Producer: write a given number of times to shared buffer
 static void app_thread_producer(void *param1, void *param2, void *param3) {
 
@@ -90,15 +100,8 @@ static void app_thread_producer(void *param1, void *param2, void *param3) {
 
   // Fill shared buffer with task number
   for (uint8_t i = 0; i < num_writes; i++) {
-    sys_sem_take(&bin_sem2, K_FOREVER); // Empty buffer?
-    // Critical section (accessing shared buffer)
-    sys_mutex_lock(&mutex, K_FOREVER); // Take muex lock to access buffer
     LOG_INF("producer thread[%d] %d", num, num);
-    buf[head] = num;
-    head = (head + 1) % BUF_SIZE;
-    sys_mutex_unlock(&mutex); // Release mutex lock of buffer
-    sys_sem_give(
-        &bin_sem1); // Signal the consumer that new queue item is available
+    buf.Put(num); // waits for a free slot
   }
 }
 
@@ -115,19 +118,8 @@ static void app_thread_consumer(void *param1, void *param2, void *param3) {
   // Read from buffer
   while (1) {
 
-    // Critical section (accessing shared buffer and Serial)
-    sys_sem_take(&bin_sem1,
-                 K_FOREVER); // wait till new buff is produced in the queue
-
-    sys_mutex_lock(&mutex,
-                   K_FOREVER); // mutex to access the shared buff: acquire lock
-
-    val = buf[tail];
-    tail = (tail + 1) % BUF_SIZE;
+    buf.Get(val); // wait till new buff is produced in the queue
     LOG_INF("consumer thread[%d] %d", num, val);
-
-    sys_mutex_unlock(&mutex); // mutex to access the shared buff: release lock
-    sys_sem_give(&bin_sem2);  // signal the buff value consumption
     k_msleep(1);
   }
 }
@@ -148,10 +140,7 @@ static void app_thread_init(void *param1, void *param2, void *param3) {
   // Create mutexes and semaphores before starting tasks
 
   sys_sem_init(&bin_sem, 0, 1);
-  sys_sem_init(&bin_sem1, 0, num_prod_tasks); // incrementing semaphore
-  sys_sem_init(&bin_sem2, num_cons_tasks,
-               num_cons_tasks); // decrementing semaphore
-  sys_mutex_init(&mutex);
+  buf.Init();
 }
 
 // Entry Point(EP) to userspace: create all the user space threads in this
@@ -178,6 +167,9 @@ void userspace_thread_init(void *param1, void *param2, void *param3) {
 
   //  k_thread_access_grant(&app_init_thread, &bin_sem, &mutex, &bin_sem2,
   //  &bin_sem1);
+#if CONFIG_APP_STACK_WATCH
+  stack_watch.Watch(&app_init_thread, "app_init_thread", "INIT");
+#endif
   LOG_INF("Starting app_init_thread....");
   k_thread_start(&app_init_thread);
 
@@ -195,8 +187,10 @@ void userspace_thread_init(void *param1, void *param2, void *param3) {
         K_THREAD_STACK_SIZEOF(stack_app_producer_thread0), app_thread_producer,
         (void *)&parameter1, nullptr, nullptr, thread_priority, K_USER,
         K_FOREVER);
-    // k_thread_access_grant(&app_producer_thread[i], &bin_sem, &mutex,
-    // &bin_sem2, &bin_sem1);
+    buf.Grant(app_producer_thread_tid[i]);
+#if CONFIG_APP_STACK_WATCH
+    stack_watch.Watch(&app_producer_thread[i], producer_names[i], "PRODUCER");
+#endif
     k_thread_start(app_producer_thread_tid[i]);
     sys_sem_take(&bin_sem, K_FOREVER);
   }
@@ -209,8 +203,10 @@ void userspace_thread_init(void *param1, void *param2, void *param3) {
         K_THREAD_STACK_SIZEOF(stack_app_consumer_thread0), app_thread_consumer,
         (void *)&parameter1, nullptr, nullptr, thread_priority, K_USER,
         K_FOREVER);
-    // k_thread_access_grant(&app_consumer_thread[i], &bin_sem, &mutex,
-    // &bin_sem2, &bin_sem1);
+    buf.Grant(app_consumer_thread_tid[i]);
+#if CONFIG_APP_STACK_WATCH
+    stack_watch.Watch(&app_consumer_thread[i], consumer_names[i], "CONSUMER");
+#endif
     k_thread_start(app_consumer_thread_tid[i]);
     sys_sem_take(&bin_sem, K_NO_WAIT);
     // k_msleep(100);
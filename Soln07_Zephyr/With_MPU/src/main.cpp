@@ -17,17 +17,11 @@
 
 LOG_MODULE_REGISTER(main, CONFIG_LOG_DEFAULT_LEVEL);
 
-// Threads
-#if CONFIG_BOARD_ESP
-constexpr size_t kThreadStackSize = 4 * 1024;
-#else
-constexpr size_t kThreadStackSize = 2 * 1024;
-#endif
-
 static k_thread userspace_thread;
 static k_tid_t userspace_thread_tid;
 
-K_THREAD_STACK_DEFINE(stack_userspace_thread, kThreadStackSize);
+K_THREAD_STACK_DEFINE(stack_userspace_thread,
+                      StackSize(CONFIG_APP_STACK_SIZE_USER));
 
 constexpr int thread_priority = K_PRIO_PREEMPT(-1);
 
@@ -45,7 +39,16 @@ extern "C" int main(void) {
 
   k_thread_start(userspace_thread_tid);
 
+#if CONFIG_APP_STACK_WATCH
+  stack_watch.Watch(userspace_thread_tid, "userspace_thread", "USER");
+  // the consumers never return: report while waiting
+  while (k_thread_join(userspace_thread_tid,
+                       K_MSEC(CONFIG_APP_STACK_WATCH_PERIOD_MS))) {
+    stack_watch.Report();
+  }
+#else
   k_thread_join(userspace_thread_tid, K_FOREVER);
+#endif
 
   LOG_INF("---end of main---");
   return 0;
@@ -0,0 +1,96 @@
+#include <cstring>
+
+#include <zephyr/logging/log.h>
+
+#include "stackwatch.h"
+
+LOG_MODULE_REGISTER(stackwatch, CONFIG_LOG_DEFAULT_LEVEL);
+
+size_t StackWatch::Suggest(size_t used) {
+  size_t size = ROUND_UP(MAX(used + used / 4, kMinStack), kAlign);
+  // MPU/userspace builds round a stack object up (to a power of 2 on some
+  // MPUs): the slack is usable stack, suggest what is really allocated
+  return K_THREAD_STACK_LEN(size) - K_THREAD_STACK_RESERVED;
+}
+
+int StackWatch::Watch(const k_thread *thread, const char *name,
+                      const char *group) {
+  size_t size = thread->stack_info.size; // usable size, without guard areas
+  k_spinlock_key_t key = k_spin_lock(&m_lock);
+
+  size_t group_id = 0;
+  while (group_id < m_group_count && strcmp(m_groups[group_id], group)) {
+    group_id++;
+  }
+  if (group_id == m_group_count) {
+    if (m_group_count == kMaxGroups) {
+      k_spin_unlock(&m_lock, key);
+      return -ENOMEM;
+    }
+    m_groups[m_group_count++] = group;
+  }
+
+  for (size_t i = 0; i < m_count; i++) {
+    if (m_threads[i].thread == thread) {
+      m_threads[i].name = name;
+      m_threads[i].group = group_id;
+      m_threads[i].size = size;
+      k_spin_unlock(&m_lock, key);
+      return 0;
+    }
+  }
+  if (m_count == kMaxThreads) {
+    k_spin_unlock(&m_lock, key);
+    return -ENOMEM;
+  }
+  m_threads[m_count++] = {thread, name, static_cast<uint8_t>(group_id), size,
+                          0};
+  k_spin_unlock(&m_lock, key);
+  return 0;
+}
+
+void StackWatch::Sample() {
+  // entries are only appended: walk the stacks (slow) outside the lock
+  k_spinlock_key_t key = k_spin_lock(&m_lock);
+  size_t count = m_count;
+  k_spin_unlock(&m_lock, key);
+
+  for (size_t i = 0; i < count; i++) {
+    size_t unused;
+    if (k_thread_stack_space_get(m_threads[i].thread, &unused)) {
+      continue;
+    }
+    size_t used = unused < m_threads[i].size ? m_threads[i].size - unused : 0;
+    m_threads[i].max_used = MAX(m_threads[i].max_used, used);
+  }
+}
+
+void StackWatch::Report() {
+  size_t group_used[kMaxGroups] = {};
+  size_t group_size[kMaxGroups] = {};
+  size_t group_threads[kMaxGroups] = {};
+
+  Sample();
+  for (size_t i = 0; i < m_count; i++) {
+    const entry_t &entry = m_threads[i];
+    LOG_INF("stack %s: size %u used %u free %u", entry.name,
+            (uint32_t)entry.size, (uint32_t)entry.max_used,
+            (uint32_t)(entry.size - entry.max_used));
+    group_used[entry.group] = MAX(group_used[entry.group], entry.max_used);
+    group_size[entry.group] += K_THREAD_STACK_LEN(entry.size);
+    group_threads[entry.group]++;
+  }
+
+  size_t total = 0;
+  size_t total_suggested = 0;
+  for (size_t g = 0; g < m_group_count; g++) {
+    size_t suggested = Suggest(group_used[g]);
+    LOG_INF("stack suggest CONFIG_APP_STACK_SIZE_%s=%u", m_groups[g],
+            (uint32_t)suggested);
+    total += group_size[g];
+    total_suggested += K_THREAD_STACK_LEN(suggested) * group_threads[g];
+  }
+  // stack objects as allocated, guard and alignment included
+  LOG_INF("stack total %u bytes, suggested %u bytes", (uint32_t)total,
+          (uint32_t)total_suggested);
+}
@@ -0,0 +1,83 @@
+#ifndef PWMFADE_H
+#define PWMFADE_H
+
+#include <array>
+
+#include <zephyr/drivers/pwm.h>
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+
+// Perceived brightness 0..255 -> duty cycle 0..65535, gamma 2.5, built at
+// compile time (x^2.5 = x^2 * sqrt(x), sqrt by Newton iteration).
+constexpr size_t kGammaLevels = 256;
+
+constexpr double GammaSqrt(double x) {
+  double root = x > 1.0 ? x : 1.0;
+  for (int i = 0; i < 32; i++) {
+    root = (root + x / root) / 2.0;
+  }
+  return root;
+}
+
+constexpr std::array<uint16_t, kGammaLevels> MakeGammaTable() {
+  std::array<uint16_t, kGammaLevels> table{};
+  for (size_t i = 0; i < kGammaLevels; i++) {
+    double x = static_cast<double>(i) / (kGammaLevels - 1);
+    table[i] = static_cast<uint16_t>(x * x * GammaSqrt(x) * 65535.0 + 0.5);
+  }
+  return table;
+}
+
+inline constexpr std::array<uint16_t, kGammaLevels> kGammaTable =
+    MakeGammaTable();
+
+static_assert(kGammaTable[0] == 0 && kGammaTable[kGammaLevels - 1] == 65535);
+
+// Fades several pwm channels without ever sleeping: a delayable work item
+// advances every active fade by one step every kStepMs and re-schedules
+// itself while a fade is running, so the system workqueue only spends one
+// pwm_set per channel per step. Fade()/Set()/Cancel() may be called from
+// any thread, timer or ISR, and retarget a running fade from its current
+// level.
+class PwmFade {
+public:
+  constexpr static size_t kMaxChannels = 4;
+  constexpr static uint32_t kStepMs = 10;
+
+private:
+  struct channel_st {
+    const pwm_dt_spec *spec;
+    uint32_t period;
+    uint8_t level; // current, perceived brightness
+    uint8_t from;
+    uint8_t to;
+    uint32_t step;
+    uint32_t steps; // 0 -> idle
+    bool dirty;     // level changed, pwm not updated yet
+  };
+
+  channel_st m_channels[kMaxChannels];
+  size_t m_count = 0;
+  k_spinlock m_lock;
+  k_work_delayable m_work;
+
+  static void WorkHandler(k_work *work);
+  int Apply(size_t ch, uint8_t level);
+
+public:
+  PwmFade() = default;
+  void Init();
+  // period: the calibrated pwm period for spec, returns the channel id
+  int Add(const pwm_dt_spec &spec, uint32_t period);
+  // from the current level to level in duration_ms (0: immediately)
+  int Fade(int ch, uint8_t level, uint32_t duration_ms);
+  int Fade(int ch, uint8_t from, uint8_t to, uint32_t duration_ms);
+  int Set(int ch, uint8_t level) { return Fade(ch, level, 0); }
+  // stop a running fade where it is
+  int Cancel(int ch);
+  uint8_t Level(int ch) const;
+  bool Busy(int ch) const;
+  ~PwmFade() = default;
+};
+
+#endif // PWMFADE_H
@@ -9,6 +9,7 @@
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 
+#include "pwmfade.h"
 #include "uartpolling.h"
 
 #define LED_DELAY_DEF (500U)
@@ -34,6 +35,7 @@ constexpr int thread_0_prio = 10;
 constexpr const device *uart_port = (DEVICE_DT_GET(DT_ALIAS(usercom0)));
 
 UartPolling user_com_port{uart_port};
+k_poll_signal uart_rx_signal; // raised by the uart rx irq
 
 constexpr const pwm_dt_spec pwm_led = PWM_DT_SPEC_GET(DT_ALIAS(user_pwm_led));
 
@@ -47,90 +49,57 @@ constexpr pwm_type kMaxPWMPeriod = PWM_MSEC(0.5f);
 constexpr pwm_type kMaxPWMPeriod = PWM_MSEC(10U); // 20U
 #endif
 
-constexpr pwm_type kBrightnessLevels = 100U;
+constexpr uint8_t kLedFull = kGammaLevels - 1;
+constexpr uint32_t kLedFadeMs = 1000U;
 
 static pwm_type max_period = kMaxPWMPeriod;
 
+// fades run from a delayable work item, one step per 10ms, never blocking
+PwmFade pwm_fade;
+static int led_channel = -1;
+
 // timer
 k_timer led_off_timer;
 
-void led_off_work_handler(struct k_work *work);
-void led_off_timer_expiry_handler(k_timer *id);
-
-k_work led_off_work = {
-    .handler = led_off_work_handler,
-};
-
-void led_off_work_handler(struct k_work *work) {
-
-  int ret;
-
-  static pwm_type pulse_width;
-  pulse_width = max_period;
-  pwm_type level = kBrightnessLevels;
-
-  pwm_set_dt(&pwm_led, max_period, max_period);
-
-  while (level) {
-
-    pulse_width = ((--level) * max_period) / kBrightnessLevels;
-
-    // ret = pwm_set_dt(&pwm_led, max_period, pulse_width);
-    ret = pwm_set_pulse_dt(&pwm_led, pulse_width);
-
-    if (ret) {
-      LOG_ERR("Error setting pulse width: %d\n", ret);
-      LOG_ERR("pulse_width %u, level %u, max: %u: \n", pulse_width, level,
-              max_period);
-      break;
-    }
-
-    LOG_DBG("pulse_width %u, level %u, max: %u: \n", pulse_width, level,
-            max_period);
-    k_msleep(10U); // 10ms
-  }
-  pwm_set_dt(&pwm_led, max_period, 0); // turn off the led completely
-}
-
 void led_off_timer_expiry_handler(k_timer *id) {
-  // handle timer expiry
-  k_work_submit(&led_off_work);
+  // starts the fade out and returns, safe from the timer ISR
+  pwm_fade.Fade(led_channel, 0, kLedFadeMs);
 }
 
 static void uart_read_thread(void *param1, void *param2, void *param3) {
-  int ret = 0;
   size_t index = 0;
   size_t read_buff_size = 100;
   unsigned char read_buff[read_buff_size] = {'0'};
 
+  k_poll_event events[] = {K_POLL_EVENT_INITIALIZER(
+      K_POLL_TYPE_SIGNAL, K_POLL_MODE_NOTIFY_ONLY, &uart_rx_signal)};
+
   while (true) {
+    // sleep until the uart rx irq fires, no polling delay
+    k_poll(events, ARRAY_SIZE(events), K_FOREVER);
+    events[0].state = K_POLL_STATE_NOT_READY;
 
-    do {
-      while (!(ret = user_com_port.Read(read_buff[index]))) {
-        user_com_port.Write(read_buff[index++]);
+    while (!user_com_port.Read(read_buff[index])) {
+      user_com_port.Write(read_buff[index++]);
 
-        if (index > read_buff_size - 1) {
-          index = read_buff_size - 1;
-          ret = 1;
-          break;
-        }
-        // k_msleep(2.5 * UART_DELAY);
+      if (index > read_buff_size - 1) {
+        index = read_buff_size - 1;
+        break;
       }
-    } while (!ret);
+    }
 
     if (index) {
-      int ret = pwm_set_dt(&pwm_led, max_period, max_period);
-      if (ret) {
-        LOG_ERR("Error setting pulse width: %d\n", ret);
-        LOG_ERR("pulse_width %d, max: %u: \n", max_period, max_period);
-      }
+      // full on right away, also cuts short a fade out in progress
+      pwm_fade.Set(led_channel, kLedFull);
       k_timer_start(&led_off_timer, K_MSEC(5000), K_NO_WAIT);
+      LOG_DBG("byte-in to led-on %u us",
+              k_cyc_to_us_floor32(k_cycle_get_32() - user_com_port.RxStamp()));
     }
 
     read_buff[index] = '\0';
     memset(read_buff, 0, index + 1); // clear the local buffer
     index = 0;
-    k_msleep(UART_DELAY);
+    user_com_port.RearmRxSignal();
   }
 }
 
@@ -155,16 +124,27 @@ extern "C" int main(void) {
   LOG_INF("PWM led: Done calibrating; maximum/minimum periods %u/%u nsec",
           max_period, kMinPWMPeriod);
 
-  if (!user_com_port.Init()) {
-    LOG_ERR("uart config failed ...");
-    return 0;
-  }
+  pwm_fade.Init();
+  led_channel = pwm_fade.Add(pwm_led, max_period);
 
   if (!user_com_port.IsReady()) {
     LOG_ERR("uart port not found...");
     return 0;
   }
 
+  // -ENOSYS: no runtime configuration, keep the devicetree settings
+  int err = user_com_port.Init();
+  if (err && err != -ENOSYS) {
+    LOG_ERR("uart config failed (%d)", err);
+    return 0;
+  }
+
+  k_poll_signal_init(&uart_rx_signal);
+  if (user_com_port.SetRxSignal(&uart_rx_signal)) {
+    LOG_ERR("uart rx irq setup failed...");
+    return 0;
+  }
+
   k_timer_init(&led_off_timer, led_off_timer_expiry_handler, nullptr);
 
   LOG_INF("Starting uart Thread ...");
@@ -0,0 +1,141 @@
+#include "pwmfade.h"
+
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(pwmfade, CONFIG_LOG_DEFAULT_LEVEL);
+
+void PwmFade::Init() { k_work_init_delayable(&m_work, WorkHandler); }
+
+int PwmFade::Add(const pwm_dt_spec &spec, uint32_t period) {
+  k_spinlock_key_t key = k_spin_lock(&m_lock);
+
+  if (m_count == kMaxChannels) {
+    k_spin_unlock(&m_lock, key);
+    return -ENOMEM;
+  }
+  int ch = m_count++;
+  m_channels[ch] = {.spec = &spec,
+                    .period = period,
+                    .level = 0,
+                    .from = 0,
+                    .to = 0,
+                    .step = 0,
+                    .steps = 0,
+                    .dirty = false};
+  k_spin_unlock(&m_lock, key);
+
+  Apply(ch, 0);
+  return ch;
+}
+
+int PwmFade::Fade(int ch, uint8_t level, uint32_t duration_ms) {
+  if (ch < 0 || static_cast<size_t>(ch) >= m_count) {
+    return -EINVAL;
+  }
+  return Fade(ch, m_channels[ch].level, level, duration_ms);
+}
+
+int PwmFade::Fade(int ch, uint8_t from, uint8_t to, uint32_t duration_ms) {
+  if (ch < 0 || static_cast<size_t>(ch) >= m_count) {
+    return -EINVAL;
+  }
+
+  k_spinlock_key_t key = k_spin_lock(&m_lock);
+  channel_st &channel = m_channels[ch];
+  channel.from = from;
+  channel.to = to;
+  channel.step = 0;
+  channel.steps = duration_ms / kStepMs;
+  if (!channel.steps) {
+    channel.level = to; // applied by the next work run
+  } else {
+    channel.level = from;
+  }
+  channel.dirty = true;
+  k_spin_unlock(&m_lock, key);
+
+  // runs the first step now, a pending run is moved up
+  k_work_reschedule(&m_work, K_NO_WAIT);
+  return 0;
+}
+
+int PwmFade::Cancel(int ch) {
+  if (ch < 0 || static_cast<size_t>(ch) >= m_count) {
+    return -EINVAL;
+  }
+  k_spinlock_key_t key = k_spin_lock(&m_lock);
+  m_channels[ch].steps = 0;
+  k_spin_unlock(&m_lock, key);
+  return 0;
+}
+
+uint8_t PwmFade::Level(int ch) const {
+  if (ch < 0 || static_cast<size_t>(ch) >= m_count) {
+    return 0;
+  }
+  return m_channels[ch].level;
+}
+
+bool PwmFade::Busy(int ch) const {
+  if (ch < 0 || static_cast<size_t>(ch) >= m_count) {
+    return false;
+  }
+  return m_channels[ch].steps != 0;
+}
+
+int PwmFade::Apply(size_t ch, uint8_t level) {
+  const channel_st &channel = m_channels[ch];
+  uint32_t pulse =
+      (static_cast<uint64_t>(channel.period) * kGammaTable[level]) / 65535U;
+  return pwm_set_dt(channel.spec, channel.period, pulse);
+}
+
+void PwmFade::WorkHandler(k_work *work) {
+  k_work_delayable *dwork = k_work_delayable_from_work(work);
+  PwmFade *self = CONTAINER_OF(dwork, PwmFade, m_work);
+  uint8_t levels[kMaxChannels];
+  bool update[kMaxChannels] = {false};
+  bool running = false;
+
+  // advance every fade under the lock, talk to the pwm driver outside it
+  k_spinlock_key_t key = k_spin_lock(&self->m_lock);
+  for (size_t ch = 0; ch < self->m_count; ch++) {
+    channel_st &channel = self->m_channels[ch];
+
+    if (channel.steps) {
+      if (channel.dirty) {
+        channel.dirty = false; // start level goes out first
+      } else {
+        channel.step++;
+        int32_t delta = static_cast<int32_t>(channel.to) - channel.from;
+        channel.level =
+            channel.from + (delta * static_cast<int32_t>(channel.step)) /
+                               static_cast<int32_t>(channel.steps);
+      }
+      update[ch] = true;
+      if (channel.step == channel.steps) {
+        channel.steps = 0; // reached the target
+      } else {
+        running = true;
+      }
+    } else if (channel.dirty) {
+      channel.dirty = false;
+      update[ch] = true;
+    }
+    levels[ch] = channel.level;
+  }
+  k_spin_unlock(&self->m_lock, key);
+
+  for (size_t ch = 0; ch < self->m_count; ch++) {
+    if (update[ch]) {
+      int ret = self->Apply(ch, levels[ch]);
+      if (ret) {
+        LOG_ERR("pwm fade ch %u: error %d", (uint32_t)ch, ret);
+      }
+    }
+  }
+
+  if (running) {
+    k_work_schedule(&self->m_work, K_MSEC(kStepMs));
+  }
+}
@@ -0,0 +1,94 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include <zephyr/kernel.h>
+
+// Lock-free single producer / single consumer ring, e.g. timer ISR ->
+// thread. Indices run freely and are masked on access, so all N slots are
+// usable. Only loads and stores of the indices are used (no read-modify-
+// write), the producer publishes a slot with a release store of m_head and
+// the consumer hands it back with a release store of m_tail.
+//
+// Reserve()/Commit() and Front()/Release() work on the slot in place, no
+// copy of T. Blocking is left to the user (e.g. a k_sem given per Commit).
+#ifdef CONFIG_DCACHE_LINE_SIZE
+constexpr size_t kSpscCacheLine = CONFIG_DCACHE_LINE_SIZE;
+#else
+constexpr size_t kSpscCacheLine = 32;
+#endif
+
+template <typename T, size_t N> class SpscRing {
+  static_assert(N && (N & (N - 1)) == 0, "N must be a power of 2");
+  static_assert(std::atomic<uint32_t>::is_always_lock_free,
+                "indices must be lock free for ISR use");
+
+  constexpr static uint32_t kMask = N - 1;
+
+  // producer and consumer index on their own cache lines
+  alignas(kSpscCacheLine) std::atomic<uint32_t> m_head{0};
+  alignas(kSpscCacheLine) std::atomic<uint32_t> m_tail{0};
+  alignas(kSpscCacheLine) T m_slots[N];
+
+public:
+  constexpr static size_t kCapacity = N;
+
+  // producer side: nullptr when full, same slot until Commit()
+  T *Reserve() {
+    uint32_t head = m_head.load(std::memory_order_relaxed);
+    if (head - m_tail.load(std::memory_order_acquire) == N) {
+      return nullptr;
+    }
+    return &m_slots[head & kMask];
+  }
+
+  void Commit() {
+    m_head.store(m_head.load(std::memory_order_relaxed) + 1,
+                 std::memory_order_release);
+  }
+
+  bool Push(const T &item) {
+    T *slot = Reserve();
+    if (slot == nullptr) {
+      return false;
+    }
+    *slot = item;
+    Commit();
+    return true;
+  }
+
+  // consumer side: nullptr when empty, same slot until Release()
+  T *Front() {
+    uint32_t tail = m_tail.load(std::memory_order_relaxed);
+    if (m_head.load(std::memory_order_acquire) == tail) {
+      return nullptr;
+    }
+    return &m_slots[tail & kMask];
+  }
+
+  void Release() {
+    m_tail.store(m_tail.load(std::memory_order_relaxed) + 1,
+                 std::memory_order_release);
+  }
+
+  bool Pop(T &item) {
+    T *slot = Front();
+    if (slot == nullptr) {
+      return false;
+    }
+    item = *slot;
+    Release();
+    return true;
+  }
+
+  // exact only when called from the producer or the consumer
+  size_t Size() const {
+    return m_head.load(std::memory_order_acquire) -
+           m_tail.load(std::memory_order_acquire);
+  }
+};
+
+#endif // SPSCRING_H
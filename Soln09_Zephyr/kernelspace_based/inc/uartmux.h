@@ -0,0 +1,65 @@
+#ifndef UARTMUX_H
+#define UARTMUX_H
+
+#include <atomic>
+#include <string_view>
+
+#include <zephyr/kernel.h>
+
+#include "uartpolling.h"
+
+// Carries several logical channels over one UartPolling port. Producers
+// queue packets per channel without blocking (a full queue drops and counts
+// the packet), a single tx thread running Run() always sends the highest
+// priority pending packet first, so a burst of telemetry never delays an
+// interactive reply by more than one packet.
+//
+// On the wire each packet is COBS( channel[1] | payload ) 0x00, see
+// telemetry.h for the COBS encoder and scripts/uart_demux.py for the host.
+// The rx direction is left raw: the host types into the console directly.
+class UartMux {
+public:
+  // lower value = higher priority
+  enum Channel : uint8_t { kConsole = 0, kLog, kTelemetry, kChannelCount };
+
+  constexpr static size_t kMaxPayload = 60;
+
+private:
+  using packet_t = struct packet_st {
+    uint8_t len;
+    uint8_t data[kMaxPayload];
+  } __attribute__((aligned(4)));
+
+  constexpr static size_t kQueueLength[kChannelCount] = {8, 8, 4};
+  constexpr static size_t kMaxFrame = 1 + kMaxPayload + 1 + 1;
+
+  UartPolling &m_port;
+
+  k_msgq m_queue[kChannelCount];
+  char __aligned(4) m_console_buffer[kQueueLength[kConsole] * sizeof(packet_t)];
+  char __aligned(4) m_log_buffer[kQueueLength[kLog] * sizeof(packet_t)];
+  char __aligned(4)
+      m_telemetry_buffer[kQueueLength[kTelemetry] * sizeof(packet_t)];
+
+  k_sem m_pending; // one count per queued packet, any channel
+  std::atomic<uint32_t> m_dropped[kChannelCount];
+
+public:
+  UartMux(UartPolling &port);
+  int Init();
+  // Splits data into packets of at most kMaxPayload bytes, returns -ENOMEM
+  // if a packet had to be dropped.
+  int Send(Channel channel, const uint8_t *data, size_t len);
+  int Send(Channel channel, std::string_view data);
+  // tx loop, never returns: run it from a dedicated thread
+  void Run();
+  // route LOG_* output into the log channel instead of the raw uart backend
+  int CaptureLogs();
+  uint32_t Dropped(Channel channel) const {
+    return m_dropped[channel].load();
+  }
+
+  ~UartMux() = default;
+};
+
+#endif // UARTMUX_H
@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""
+Host side demux for UartMux (UART_MUX 1 in main.cpp).
+
+Every packet on the wire is COBS(channel | payload) followed by 0x00.
+Console and log channels are printed as text, telemetry payloads are
+checked (crc16/ccitt) and printed as samples per adc channel, gaps in the
+telemetry sequence number are reported as dropped frames.
+
+usage: uart_demux.py /dev/ttyACM0 [baud]     (needs pyserial)
+       uart_demux.py capture.bin              (raw capture file)
+"""
+import struct
+import sys
+
+CH_CONSOLE, CH_LOG, CH_TELEMETRY = 0, 1, 2
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0:
+            raise ValueError("zero byte inside cobs frame")
+        i += 1
+        out += data[i:i + code - 1]
+        i += code - 1
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def crc16_ccitt(data, crc=0xFFFF):
+    # same as zephyr crc16_ccitt(): reflected poly 0x8408
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0x8408 if crc & 1 else crc >> 1
+    return crc
+
+
+class Demux:
+    def __init__(self):
+        self.pending = bytearray()
+        self.last_seq = None
+        self.dropped = 0
+        self.bad = 0
+
+    def feed(self, chunk):
+        self.pending += chunk
+        while b"\x00" in self.pending:
+            frame, _, rest = self.pending.partition(b"\x00")
+            self.pending = bytearray(rest)
+            if frame:
+                self.packet(bytes(frame))
+
+    def packet(self, frame):
+        try:
+            raw = cobs_decode(frame)
+        except ValueError:
+            self.bad += 1
+            return
+        if not raw:
+            return
+        channel, payload = raw[0], raw[1:]
+        if channel == CH_CONSOLE:
+            sys.stdout.write(payload.decode(errors="replace"))
+        elif channel == CH_LOG:
+            sys.stdout.write("[log] " + payload.decode(errors="replace"))
+        elif channel == CH_TELEMETRY:
+            self.telemetry(payload)
+        sys.stdout.flush()
+
+    def telemetry(self, payload):
+        if len(payload) < 6:
+            self.bad += 1
+            return
+        body, crc = payload[:-2], struct.unpack("<H", payload[-2:])[0]
+        if crc16_ccitt(body) != crc:
+            self.bad += 1
+            return
+        seq, channel, count = struct.unpack("<HBB", body[:4])
+        samples = struct.unpack("<%dH" % count, body[4:4 + 2 * count])
+        if self.last_seq is not None:
+            gap = (seq - self.last_seq - 1) & 0xFFFF
+            if gap:
+                self.dropped += gap
+                print("[telemetry] %d frame(s) lost before seq %d" % (gap, seq))
+        self.last_seq = seq
+        print("[telemetry] seq %5d ch%d: %s"
+              % (seq, channel, " ".join(map(str, samples))))
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        return 1
+    demux = Demux()
+    source = sys.argv[1]
+    if source.startswith("/dev/") or source.upper().startswith("COM"):
+        import serial  # pyserial
+
+        baud = int(sys.argv[2]) if len(sys.argv) > 2 else 115200
+        with serial.Serial(source, baud, timeout=0.1) as port:
+            try:
+                while True:
+                    demux.feed(port.read(256))
+            except KeyboardInterrupt:
+                pass
+    else:
+        with open(source, "rb") as capture:
+            demux.feed(capture.read())
+    print("frames lost: %d, bad packets: %d" % (demux.dropped, demux.bad))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
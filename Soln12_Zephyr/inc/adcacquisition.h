@@ -0,0 +1,189 @@
+#ifndef ADCACQUISITION_H
+#define ADCACQUISITION_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include <zephyr/drivers/adc.h>
+#include <zephyr/kernel.h>
+
+#include "spscring.h"
+
+// Block based adc acquisition of kChannels channels, kSamples samplings per
+// block, into a ring of kBlocks blocks. One adc_sequence scanning all
+// channels (channel mask) is built at Init() and reused for every block, the
+// driver paces the samplings itself (options.interval_us, extra_samplings)
+// with no cpu work per sample beyond its own isr:
+//
+//   trigger (timer -> work item)   Trigger()     reserve a block,
+//                                                adc_read_async()
+//   adc isr, last sampling                       commit the block
+//   consumer thread                Front()       waits for a block
+//                                  Release()     hands it back
+//
+// The block is committed from the adc isr, so the adc fills the next block
+// while the consumer still works on older ones (up to kBlocks). The
+// k_poll_signal of adc_read_async() reports the end of the read, Trigger()
+// checks it without blocking before it starts the next one.
+//
+// The driver stores a scan interleaved (ch0 ch1 .. chN per sampling), the
+// sampling callback moves each sampling into the block as one contiguous
+// array per channel (structure of arrays):
+//
+//   block.adc_val[channel][sample], channel in the order of the adc_dt_spec
+//
+// adc_read_async() takes the adc context lock, so Trigger() must run in
+// thread context (a work item is fine), not in the timer ISR itself.
+template <size_t kChannels, size_t kSamples, size_t kBlocks>
+class AdcAcquisition {
+public:
+  struct Block {
+    uint16_t adc_val[kChannels][kSamples];
+  };
+
+  // idle samplings between two blocks, so a trigger never finds the
+  // previous read still running
+  constexpr static uint32_t kTriggerSlack = 2;
+
+private:
+  const adc_dt_spec (&m_specs)[kChannels];
+  adc_sequence_options m_options;
+  adc_sequence m_sequence;
+  k_poll_signal m_done;
+  k_sem m_ready; // one count per committed block
+  std::atomic<bool> m_busy{false};
+  std::atomic<uint32_t> m_overruns{0};
+  std::atomic<uint32_t> m_dropped{0};
+  std::atomic<uint32_t> m_errors{0};
+
+  SpscRing<Block, kBlocks> m_ring;
+  uint16_t m_scan[kSamples * kChannels]; // driver side, interleaved
+  uint8_t m_scan_pos[kChannels];         // spec index -> position in a scan
+  Block *m_block = nullptr;
+
+  // adc isr, after every sampling of the sequence
+  static adc_action OnSampling(const device *dev, const adc_sequence *sequence,
+                               uint16_t sampling_index) {
+    ARG_UNUSED(dev);
+    auto *self = static_cast<AdcAcquisition *>(sequence->options->user_data);
+    const uint16_t *scan = &self->m_scan[sampling_index * kChannels];
+
+    for (size_t ch = 0; ch < kChannels; ch++) {
+      self->m_block->adc_val[ch][sampling_index] = scan[self->m_scan_pos[ch]];
+    }
+    if (sampling_index == kSamples - 1) {
+      self->m_ring.Commit(); // block complete: publish it
+      k_sem_give(&self->m_ready);
+    }
+    return ADC_ACTION_CONTINUE;
+  }
+
+public:
+  AdcAcquisition(const adc_dt_spec (&specs)[kChannels]) : m_specs(specs) {}
+
+  // Sets up all channels (same adc device) and the sequence, samplings are
+  // taken every interval_us.
+  int Init(uint32_t interval_us) {
+    m_sequence = {};
+    for (size_t ch = 0; ch < kChannels; ch++) {
+      const adc_dt_spec &spec = m_specs[ch];
+      if (!adc_is_ready_dt(&spec) || spec.dev != m_specs[0].dev) {
+        return -ENODEV;
+      }
+      int ret = adc_channel_setup_dt(&spec);
+      if (ret < 0) {
+        return ret;
+      }
+      m_sequence.channels |= BIT(spec.channel_id);
+    }
+
+    // a scan is stored in ascending channel id order
+    for (size_t ch = 0; ch < kChannels; ch++) {
+      m_scan_pos[ch] = 0;
+      for (size_t other = 0; other < kChannels; other++) {
+        m_scan_pos[ch] += (m_specs[other].channel_id < m_specs[ch].channel_id);
+      }
+    }
+
+    uint32_t channels = m_sequence.channels;
+    int ret = adc_sequence_init_dt(&m_specs[0], &m_sequence);
+    if (ret < 0) {
+      return ret;
+    }
+    m_sequence.channels = channels;
+
+    m_options = {};
+    m_options.interval_us = interval_us;
+    m_options.callback = OnSampling;
+    m_options.user_data = this;
+    m_options.extra_samplings = kSamples - 1; // first sampling + extra ones
+
+    m_sequence.options = &m_options;
+    m_sequence.buffer = m_scan;
+    /* buffer size in bytes, not number of samples */
+    m_sequence.buffer_size = sizeof(m_scan);
+
+    k_poll_signal_init(&m_done);
+    return k_sem_init(&m_ready, 0, kBlocks);
+  }
+
+  // Starts the next block. -EBUSY (overrun) while the previous read is still
+  // running, -ENOBUFS (dropped) when the consumer holds every block.
+  int Trigger() {
+    if (m_busy.load(std::memory_order_acquire)) {
+      unsigned int signaled;
+      int result;
+      k_poll_signal_check(&m_done, &signaled, &result);
+      if (!signaled) {
+        m_overruns.fetch_add(1);
+        return -EBUSY;
+      }
+      // a failed read never reached its last sampling: the block was not
+      // committed and is reserved again below
+      k_poll_signal_reset(&m_done);
+      if (result) {
+        m_errors.fetch_add(1);
+      }
+      m_busy.store(false, std::memory_order_release);
+    }
+
+    m_block = m_ring.Reserve();
+    if (m_block == nullptr) {
+      m_dropped.fetch_add(1);
+      return -ENOBUFS;
+    }
+
+    m_busy.store(true, std::memory_order_release);
+    int ret = adc_read_async(m_specs[0].dev, &m_sequence, &m_done);
+    if (ret < 0) {
+      m_busy.store(false, std::memory_order_release);
+      m_errors.fetch_add(1);
+    }
+    return ret;
+  }
+
+  // consumer side: the oldest committed block, nullptr on timeout
+  const Block *Front(k_timeout_t timeout) {
+    if (k_sem_take(&m_ready, timeout)) {
+      return nullptr;
+    }
+    return m_ring.Front();
+  }
+
+  // the adc may refill the block from here on
+  void Release() { m_ring.Release(); }
+
+  uint32_t Overruns() const { return m_overruns.load(); }
+  uint32_t Dropped() const { return m_dropped.load(); }
+  uint32_t Errors() const { return m_errors.load(); }
+  // trigger period: the conversion time of a block plus kTriggerSlack idle
+  // samplings
+  uint32_t TriggerPeriodUs() const {
+    return m_options.interval_us * (kSamples + kTriggerSlack);
+  }
+
+  ~AdcAcquisition() = default;
+};
+
+#endif // ADCACQUISITION_H
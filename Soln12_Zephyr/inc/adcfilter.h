@@ -0,0 +1,127 @@
+#ifndef ADCFILTER_H
+#define ADCFILTER_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+#include <zephyr/kernel.h>
+
+// Fixed point streaming filters for the adc blocks. Every stage keeps its
+// state between blocks and costs O(1) (FIR: O(taps)) per sample, no floats:
+//
+//   MovingAverage<N>    running sum over the last N samples
+//   Iir<kShift>         single pole low pass, y += (x - y) / 2^kShift
+//   Fir<kCoeffs>        N taps, Q15 constexpr coefficients
+//
+// Stages are chained at compile time:
+//
+//   using AdcFilter = FilterPipeline<MovingAverage<8>, Iir<3>>;
+//   AdcFilter filter;
+//   filter.Process(samples, count); // in place, stage by stage
+
+template <size_t N> class MovingAverage {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "N must be a power of 2");
+
+  int32_t m_history[N] = {};
+  int32_t m_sum = 0;
+  size_t m_pos = 0;
+
+public:
+  constexpr static const char *kName = "moving_avg";
+
+  int32_t Process(int32_t x) {
+    m_sum += x - m_history[m_pos];
+    m_history[m_pos] = x;
+    m_pos = (m_pos + 1) & (N - 1);
+    return m_sum / static_cast<int32_t>(N);
+  }
+};
+
+template <unsigned kShift> class Iir {
+  static_assert(kShift > 0 && kShift < 16, "kShift out of range");
+
+  // state in Q16 so small steps are not lost to the shift
+  int32_t m_state = 0;
+
+public:
+  constexpr static const char *kName = "iir";
+
+  int32_t Process(int32_t x) {
+    m_state += ((x * (1 << 16)) - m_state) >> kShift;
+    return m_state >> 16;
+  }
+};
+
+template <const auto &kCoeffs> class Fir {
+  constexpr static size_t kTaps = std::size(kCoeffs);
+
+  int32_t m_history[kTaps] = {};
+  size_t m_pos = 0;
+
+public:
+  constexpr static const char *kName = "fir";
+
+  int32_t Process(int32_t x) {
+    m_history[m_pos] = x;
+    int64_t acc = 0;
+    size_t idx = m_pos;
+    for (size_t tap = 0; tap < kTaps; tap++) {
+      acc += static_cast<int64_t>(kCoeffs[tap]) * m_history[idx];
+      idx = idx ? idx - 1 : kTaps - 1;
+    }
+    m_pos = (m_pos + 1) % kTaps;
+    return static_cast<int32_t>(acc >> 15);
+  }
+};
+
+// 5 tap low pass, Q15, unity dc gain
+inline constexpr std::array<int16_t, 5> kFirLowPass5 = {2048, 8192, 12288,
+                                                        8192, 2048};
+
+template <typename... Stages> class FilterPipeline {
+public:
+  constexpr static size_t kStages = sizeof...(Stages);
+
+private:
+  std::tuple<Stages...> m_stages;
+  // cycles per sample of each stage over the last block
+  std::atomic<uint32_t> m_cycles[kStages] = {};
+
+  template <size_t I> void RunStage(int32_t *samples, size_t count) {
+    auto &stage = std::get<I>(m_stages);
+    uint32_t start = k_cycle_get_32();
+    for (size_t i = 0; i < count; i++) {
+      samples[i] = stage.Process(samples[i]);
+    }
+    m_cycles[I].store((k_cycle_get_32() - start) / count);
+  }
+
+  template <size_t... I>
+  void Run(int32_t *samples, size_t count, std::index_sequence<I...>) {
+    (RunStage<I>(samples, count), ...);
+  }
+
+public:
+  // Filters count samples in place, stage by stage so each stage loop stays
+  // tight and is timed on its own.
+  void Process(int32_t *samples, size_t count) {
+    if (count) {
+      Run(samples, count, std::index_sequence_for<Stages...>{});
+    }
+  }
+
+  uint32_t CyclesPerSample(size_t stage) const {
+    return m_cycles[stage].load();
+  }
+
+  constexpr static const char *StageName(size_t stage) {
+    constexpr const char *kNames[] = {Stages::kName...};
+    return kNames[stage];
+  }
+};
+
+#endif // ADCFILTER_H
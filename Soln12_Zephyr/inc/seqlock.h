@@ -0,0 +1,69 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Single writer, many readers publication of a small struct. Neither side
+// ever blocks or takes a lock: the writer never waits for readers, readers
+// copy a snapshot and retry only if the writer published meanwhile.
+//
+// Two copies are kept (a "latch"): while the writer updates one copy the
+// sequence number points readers to the other one, so a reader that
+// preempted the writer mid update still gets the previous consistent value
+// right away instead of spinning on it.
+//
+// The copies are stored as relaxed atomic words, so the concurrent copy is
+// well defined C++ and not a data race.
+template <typename T> class SeqLock {
+  static_assert(std::is_trivially_copyable_v<T>, "T is copied bytewise");
+
+  constexpr static size_t kWords = (sizeof(T) + 3) / 4;
+
+  std::atomic<uint32_t> m_seq{0};
+  std::atomic<uint32_t> m_copy[2][kWords] = {};
+
+  static void Store(std::atomic<uint32_t> (&copy)[kWords], const T &value) {
+    uint32_t words[kWords] = {};
+    memcpy(words, &value, sizeof(T));
+    for (size_t i = 0; i < kWords; i++) {
+      copy[i].store(words[i], std::memory_order_relaxed);
+    }
+  }
+
+public:
+  // writer side, one writer only
+  void Write(const T &value) {
+    std::atomic_thread_fence(std::memory_order_release);
+    m_seq.fetch_add(1, std::memory_order_relaxed); // odd: readers use [1]
+    std::atomic_thread_fence(std::memory_order_release);
+    Store(m_copy[0], value);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_seq.fetch_add(1, std::memory_order_relaxed); // even: readers use [0]
+    std::atomic_thread_fence(std::memory_order_release);
+    Store(m_copy[1], value);
+  }
+
+  // any context, ISR included; returns the number of writes so far
+  uint32_t Read(T &value) const {
+    uint32_t words[kWords];
+    uint32_t seq;
+
+    do {
+      seq = m_seq.load(std::memory_order_acquire);
+      const auto &copy = m_copy[seq & 1];
+      for (size_t i = 0; i < kWords; i++) {
+        words[i] = copy[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while (m_seq.load(std::memory_order_relaxed) != seq);
+
+    memcpy(&value, words, sizeof(T));
+    return seq / 2;
+  }
+};
+
+#endif // SEQLOCK_H
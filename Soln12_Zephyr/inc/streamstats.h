@@ -0,0 +1,201 @@
+#ifndef STREAMSTATS_H
+#define STREAMSTATS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+
+// Integer statistics over an unsigned sample stream, O(1) per sample:
+// min, max, mean, variance, rms and a histogram, for
+//
+//   a sliding window   the last kSliding samples, updated every sample
+//   a tumbling window  kTumbling samples, published when it is full
+//
+// Sum and sum of squares are kept exactly in 64 bit (samples are at most
+// 16 bit), so the variance has no cancellation error and a sample leaving
+// the sliding window is removed exactly. Sliding min/max use monotonic
+// queues over the window. No floats: Snapshot() returns the mean and rms in
+// 1/100 of a sample unit.
+template <size_t kSliding, size_t kTumbling, uint32_t kMaxValue = 4096,
+          size_t kBins = 16>
+class StreamStats {
+  static_assert(kSliding > 0 && kTumbling > 0, "empty window");
+  static_assert(kTumbling <= 65536, "sum * sum must fit 64 bit");
+  static_assert(kMaxValue <= 65536 && kBins > 0, "16 bit samples");
+  static_assert(kSliding <= 65536, "ring positions are 16 bit");
+
+public:
+  struct Summary {
+    uint32_t count;
+    uint16_t min;
+    uint16_t max;
+    uint32_t mean_c;   // mean * 100
+    uint32_t variance; // sample units ^ 2
+    uint32_t rms_c;    // rms * 100
+    uint32_t hist[kBins];
+  };
+
+private:
+  struct Accum {
+    uint32_t count;
+    uint64_t sum;
+    uint64_t sumsq;
+    uint16_t min;
+    uint16_t max;
+    uint32_t hist[kBins];
+  };
+
+  // monotonic queue of m_ring positions, oldest at head. All indices wrap
+  // explicitly at kSliding, nothing grows with the sample count.
+  struct Queue {
+    uint16_t pos[kSliding];
+    size_t head;
+    size_t len;
+  };
+
+  k_spinlock m_lock;
+  size_t m_pos = 0; // next m_ring slot, the oldest sample once full
+  uint16_t m_ring[kSliding];
+  Accum m_sliding = {};
+  Queue m_min_q = {};
+  Queue m_max_q = {};
+  Accum m_tumbling = {};
+  Accum m_tumbling_done = {}; // last complete tumbling window
+
+  static size_t Wrap(size_t i) { return i >= kSliding ? i - kSliding : i; }
+
+  static size_t Bin(uint16_t x) {
+    size_t bin = (static_cast<uint32_t>(x) * kBins) / kMaxValue;
+    return bin < kBins ? bin : kBins - 1;
+  }
+
+  static uint32_t Isqrt(uint64_t x) {
+    uint64_t root = 0;
+    uint64_t bit = 1ULL << 62;
+    while (bit > x) {
+      bit >>= 2;
+    }
+    while (bit) {
+      if (x >= root + bit) {
+        x -= root + bit;
+        root = (root >> 1) + bit;
+      } else {
+        root >>= 1;
+      }
+      bit >>= 2;
+    }
+    return static_cast<uint32_t>(root);
+  }
+
+  // drops the entry whose slot is being overwritten, then the ones x
+  // dominates
+  template <typename Dominates>
+  void Push(Queue &q, size_t pos, bool full, uint16_t x,
+            Dominates dominates) {
+    if (full && q.len && q.pos[q.head] == pos) {
+      q.head = Wrap(q.head + 1);
+      q.len--;
+    }
+    while (q.len && dominates(x, m_ring[q.pos[Wrap(q.head + q.len - 1)]])) {
+      q.len--;
+    }
+    q.pos[Wrap(q.head + q.len)] = static_cast<uint16_t>(pos);
+    q.len++;
+  }
+
+  void Add(uint16_t x) {
+    size_t pos = m_pos;
+    if (++m_pos == kSliding) {
+      m_pos = 0;
+    }
+    bool full = (m_sliding.count == kSliding);
+    uint32_t sq = static_cast<uint32_t>(x) * x;
+
+    // sliding: once full, the sample in this slot leaves
+    if (full) {
+      uint16_t old = m_ring[pos];
+      m_sliding.sum -= old;
+      m_sliding.sumsq -= static_cast<uint32_t>(old) * old;
+      m_sliding.hist[Bin(old)]--;
+    } else {
+      m_sliding.count++;
+    }
+    m_ring[pos] = x;
+    m_sliding.sum += x;
+    m_sliding.sumsq += sq;
+    m_sliding.hist[Bin(x)]++;
+    Push(m_min_q, pos, full, x, [](uint16_t a, uint16_t b) { return a <= b; });
+    Push(m_max_q, pos, full, x, [](uint16_t a, uint16_t b) { return a >= b; });
+
+    // tumbling
+    if (m_tumbling.count == 0) {
+      m_tumbling.min = x;
+      m_tumbling.max = x;
+    }
+    m_tumbling.count++;
+    m_tumbling.sum += x;
+    m_tumbling.sumsq += sq;
+    m_tumbling.min = MIN(m_tumbling.min, x);
+    m_tumbling.max = MAX(m_tumbling.max, x);
+    m_tumbling.hist[Bin(x)]++;
+    if (m_tumbling.count == kTumbling) {
+      m_tumbling_done = m_tumbling;
+      m_tumbling = {};
+    }
+  }
+
+  static Summary Summarize(const Accum &acc) {
+    Summary summary = {};
+    summary.count = acc.count;
+    summary.min = acc.min;
+    summary.max = acc.max;
+    for (size_t i = 0; i < kBins; i++) {
+      summary.hist[i] = acc.hist[i];
+    }
+    if (acc.count) {
+      uint64_t n = acc.count;
+      summary.mean_c = static_cast<uint32_t>(acc.sum * 100 / n);
+      summary.variance =
+          static_cast<uint32_t>((acc.sumsq - acc.sum * acc.sum / n) / n);
+      summary.rms_c = Isqrt(acc.sumsq * 10000 / n);
+    }
+    return summary;
+  }
+
+public:
+  // one lock per block, not per sample
+  void Add(const uint16_t *samples, size_t count) {
+    k_spinlock_key_t key = k_spin_lock(&m_lock);
+    for (size_t i = 0; i < count; i++) {
+      Add(samples[i]);
+    }
+    k_spin_unlock(&m_lock, key);
+  }
+
+  Summary Sliding() {
+    k_spinlock_key_t key = k_spin_lock(&m_lock);
+    Accum acc = m_sliding;
+    if (acc.count) {
+      acc.min = m_ring[m_min_q.pos[m_min_q.head]];
+      acc.max = m_ring[m_max_q.pos[m_max_q.head]];
+    }
+    k_spin_unlock(&m_lock, key);
+    return Summarize(acc);
+  }
+
+  // count is 0 until the first window completed
+  Summary Tumbling() {
+    k_spinlock_key_t key = k_spin_lock(&m_lock);
+    Accum acc = m_tumbling_done;
+    k_spin_unlock(&m_lock, key);
+    return Summarize(acc);
+  }
+
+  constexpr static size_t kSlidingLen = kSliding;
+  constexpr static size_t kTumblingLen = kTumbling;
+  constexpr static size_t kHistBins = kBins;
+};
+
+#endif // STREAMSTATS_H
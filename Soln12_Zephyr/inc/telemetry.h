@@ -0,0 +1,86 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <zephyr/sys/crc.h>
+
+// Binary telemetry frames for streaming adc blocks to a host:
+//
+//   COBS( seq[2] | channel[1] | count[1] | sample[2] * count | crc16[2] ) 0x00
+//
+// all fields little endian, crc16 is CRC-16/CCITT (seed 0xffff) over
+// seq..samples. channel is the adc channel index (io-channels order), seq
+// counts the frames of all channels. COBS removes every 0x00 from the frame
+// so the trailing 0x00 is an unambiguous delimiter, the host resyncs on it
+// after a lost byte and detects lost frames from gaps in seq.
+
+// Returns the encoded length, dst must hold len + len / 254 + 1 bytes.
+inline size_t CobsEncode(const uint8_t *src, size_t len, uint8_t *dst) {
+  size_t code_pos = 0;
+  size_t out = 1;
+  uint8_t code = 1;
+
+  for (size_t i = 0; i < len; i++) {
+    if (src[i] == 0) {
+      dst[code_pos] = code;
+      code_pos = out++;
+      code = 1;
+    } else {
+      dst[out++] = src[i];
+      if (++code == 0xFF) {
+        dst[code_pos] = code;
+        code_pos = out++;
+        code = 1;
+      }
+    }
+  }
+  dst[code_pos] = code;
+  return out;
+}
+
+template <size_t kSamples> class TelemetryFrame {
+  static_assert(kSamples <= UINT8_MAX, "count is a single byte");
+
+public:
+  constexpr static size_t kPayloadSize = 2 + 1 + 1 + 2 * kSamples + 2;
+  constexpr static size_t kFrameSize =
+      kPayloadSize + kPayloadSize / 254 + 1 + 1; // cobs overhead + 0x00
+
+private:
+  uint8_t m_payload[kPayloadSize];
+  uint8_t m_frame[kFrameSize];
+  uint16_t m_seq = 0;
+
+public:
+  // Builds the next frame from one channel's block of samples, returns its
+  // length.
+  size_t Encode(uint8_t channel, const volatile uint16_t *samples) {
+    size_t pos = 0;
+
+    m_payload[pos++] = m_seq & 0xFF;
+    m_payload[pos++] = m_seq >> 8;
+    m_payload[pos++] = channel;
+    m_payload[pos++] = kSamples;
+    for (size_t i = 0; i < kSamples; i++) {
+      uint16_t sample = samples[i];
+      m_payload[pos++] = sample & 0xFF;
+      m_payload[pos++] = sample >> 8;
+    }
+    uint16_t crc = crc16_ccitt(0xFFFF, m_payload, pos);
+    m_payload[pos++] = crc & 0xFF;
+    m_payload[pos++] = crc >> 8;
+
+    size_t len = CobsEncode(m_payload, pos, m_frame);
+    m_frame[len++] = 0x00;
+    m_seq++;
+    return len;
+  }
+
+  const uint8_t *Data() const { return m_frame; }
+  // the last frame before COBS, for links that do their own framing
+  const uint8_t *Payload() const { return m_payload; }
+};
+
+#endif // TELEMETRY_H
@@ -5,20 +5,49 @@
 
 #include <zephyr/device.h>
 #include <zephyr/drivers/adc.h>
+#if CONFIG_ADC_EMUL
+#include <zephyr/drivers/adc/adc_emul.h>
+#endif
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 
+#include "adcacquisition.h"
+#include "adcfilter.h"
+#include "command.h"
+#include "seqlock.h"
+#include "spscring.h"
+#include "streamstats.h"
+#include "telemetry.h"
+#include "uartmux.h"
 #include "uartpolling.h"
 
 #define LED_DELAY_DEF (500U)
 #define UART_DELAY (100U)
 
+// UART_MUX: 0-> console on usercom0, telemetry on usercom1
+//           1-> console, logs and telemetry multiplexed on usercom0
+#define UART_MUX 0
+
+// SPSC_BENCH: 1-> time the old volatile ring against SpscRing at startup
+#define SPSC_BENCH 0
+
 LOG_MODULE_REGISTER(main, CONFIG_LOG_DEFAULT_LEVEL);
 
 // devices
 constexpr const device *uart_port = (DEVICE_DT_GET(DT_ALIAS(usercom0)));
 
 UartPolling user_com_port{uart_port};
+k_poll_signal uart_rx_signal; // raised by the uart rx irq
+
+#if UART_MUX
+UartMux uart_mux{user_com_port};
+#else
+// binary telemetry stream of every adc block
+constexpr const device *telemetry_uart_port =
+    (DEVICE_DT_GET(DT_ALIAS(usercom1)));
+
+UartPolling telemetry_port{telemetry_uart_port};
+#endif
 
 // Threads
 #if CONFIG_BOARD_ESP
@@ -47,198 +76,428 @@ K_THREAD_STACK_DEFINE(stack_thread_1, kThreadStackSize);
 constexpr int thread_0_prio = 10;
 constexpr int thread_1_prio = 10;
 
+#if UART_MUX
+static k_thread thread_2;
+static k_tid_t thread_2_tid;
+K_THREAD_STACK_DEFINE(stack_thread_2, kThreadStackSize);
+constexpr int thread_2_prio = 9; // mux tx: drain ahead of the producers
+#endif
+
 // circular buffer
 
 constexpr size_t buffer_len =
     4; // The ring buffer has 'n' buffers that can be configured. Min. 2
 constexpr size_t buffer_mem_len = 10;
-
-using buf = struct {
-  uint16_t adc_val[buffer_mem_len];
+// channels scanned per sampling: the io-channels of the zephyr,user node
+constexpr size_t adc_channel_count =
+    DT_PROP_LEN(DT_PATH(zephyr_user), io_channels);
+// the adc paces the samples of a block, one trigger per block (plus slack,
+// see AdcAcquisition::kTriggerSlack)
+constexpr uint32_t adc_sample_interval_us = 1000; // 1 kHz
+
+// the adc fills the ring blocks in place (adc_acq), the processing thread
+// reads them in place; buffer_len must be a power of 2
+using AdcAcq = AdcAcquisition<adc_channel_count, buffer_mem_len, buffer_len>;
+// one contiguous array per channel (SoA), in io-channels order
+using buf = AdcAcq::Block;
+
+TelemetryFrame<buffer_mem_len> telemetry_frame;
+
+// latest block results, published by the processing thread, readers never
+// block it
+using adc_result_t = struct {
+  float avg[adc_channel_count];  // raw
+  int32_t mv[adc_channel_count]; // avg at the pin
+  int64_t timestamp_ms;          // uptime when the block was processed
+  uint32_t samples;              // per channel, since boot
+  uint32_t overruns;
 };
 
-volatile buf ring_buffer[buffer_len] = {0};
-volatile uint8_t head = 0;
-volatile uint8_t tail = 0;
+SeqLock<adc_result_t> adc_result;
+
+// one streaming filter per channel, last outputs published for "filter"
+using AdcFilter = FilterPipeline<MovingAverage<8>, Iir<3>, Fir<kFirLowPass5>>;
+AdcFilter adc_filter[adc_channel_count];
+std::atomic<int32_t> adc_filtered[adc_channel_count] = {};
 
-std::atomic<float> avg_adc = {0.0f};
+// per channel statistics for "stats": sliding 100 ms, tumbling 1 s at 1 kHz
+using AdcStats = StreamStats<100, 1000>;
+AdcStats adc_stats[adc_channel_count];
 
 // syncs
-k_sem signal_buff_full; // Signal a buffer is full
-k_mutex avg_mutex;      // sync between the adc processor task and uart task
 
 // Timer stuff
 
 k_timer adc_read_timer;
-// ADC:
 
-static const struct adc_dt_spec adc_chan0 =
-    ADC_DT_SPEC_GET_BY_IDX(DT_PATH(zephyr_user), 0);
+void adc_read_work_handler(struct k_work *work);
+void adc_read_timer_expiry_handler(k_timer *id);
 
-void adc_read_timer_expiry_handler(k_timer *id) {
-  // LOG_INF("ADC timer: Current cpu ID is %d", arch_curr_cpu()->id);
-  if (((head + 1) % buffer_len) == tail) {
-    // drop the elements, buffer full, sorry
-    LOG_INF("ISR: Sorry! Buffer Full!! dropping adc_values....");
-    return;
-  }
+k_work adc_read_work = {
+    .handler = adc_read_work_handler,
+};
 
-  static size_t buffer_mem_count = 0;
-
-  if (buffer_mem_count < buffer_mem_len) {
-    size_t l_buffer_mem_count = buffer_mem_count;
-
-    static uint16_t val_mv;
-    static struct adc_sequence sequence = {
-        .buffer = &val_mv,
-        /* buffer size in bytes, not number of samples */
-        .buffer_size = sizeof(val_mv),
-    };
-    (void)adc_sequence_init_dt(&adc_chan0, &sequence);
-    int err = adc_read(adc_chan0.dev, &sequence);
-    if (err < 0) {
-      LOG_ERR("unable to read ADC channel 0(%d)\n", err);
-      return;
-    }
+// ADC:
 
-    ring_buffer[head].adc_val[buffer_mem_count] = val_mv;
-    buffer_mem_count++;
+#define ADC_DT_SPEC_AND_COMMA(node_id, prop, idx)                              \
+  ADC_DT_SPEC_GET_BY_IDX(node_id, idx),
 
-#if DBG
-    LOG_INF("ISR ring_buffer[%d].adc_val[%d] = %d", head, l_buffer_mem_count,
-            ring_buffer[head].adc_val[l_buffer_mem_count]);
-#endif
-  }
+static const struct adc_dt_spec adc_channels[] = {DT_FOREACH_PROP_ELEM(
+    DT_PATH(zephyr_user), io_channels, ADC_DT_SPEC_AND_COMMA)};
 
-  if (buffer_mem_count >= buffer_mem_len) {
+AdcAcq adc_acq{adc_channels};
 
-    head = ((head + 1) % buffer_len); // let's fill the next buffer element
-    buffer_mem_count = 0;             // reset the member buffer count
+void adc_read_timer_expiry_handler(k_timer *id) {
+  // adc_read_async() takes the adc context lock: start it from thread context
+  k_work_submit(&adc_read_work);
+}
 
-    // Signal a buffer is ready to be consumed
-    k_sem_give(&signal_buff_full);
+void adc_read_work_handler(struct k_work *work) {
+  int err = adc_acq.Trigger();
+  if (err == -ENOBUFS) {
+    // drop the elements, buffer full, sorry
+    LOG_INF("ADC: Sorry! Buffer Full!! dropping adc_values....");
+  } else if (err < 0 && err != -EBUSY) { // -EBUSY: overrun, counted
+    LOG_ERR("unable to start ADC channels (%d)\n", err);
   }
 }
 
+#if CONFIG_ADC_EMUL
+// native_sim: a 0..3000 mV sawtooth with a period of 300 samples, each
+// channel a quarter period behind the previous one
+static int adc_emul_sawtooth(const device *dev, unsigned int chan, void *data,
+                             uint32_t *result) {
+  static uint32_t step[32];
+  *result = ((step[chan]++ + chan * 75) % 300) * 10;
+  return 0;
+}
+#endif
+
 static void adc_processing_thread(void *param1, void *param2, void *param3) {
 
-  uint32_t adc_sum = 0;
-  uint32_t l_tail = 0;
+  uint32_t adc_sum[adc_channel_count];
+  uint32_t samples = 0;
+  int32_t filter_buf[adc_channel_count][buffer_mem_len];
 
   k_timer_init(&adc_read_timer, adc_read_timer_expiry_handler, NULL);
   LOG_INF("Starting ADC Timer ...");
 
-  k_timer_start(&adc_read_timer, K_MSEC(100), K_MSEC(100));
+  k_timer_start(&adc_read_timer, K_USEC(adc_acq.TriggerPeriodUs()),
+                K_USEC(adc_acq.TriggerPeriodUs()));
 
   // LOG_INF("ADC Proc: Current cpu ID is %d", arch_curr_cpu()->id);
   while (true) {
-    if (!k_sem_take(&signal_buff_full, K_FOREVER)) {
-      adc_sum = 0;
-
-      for (uint8_t i = 0; i < buffer_mem_len; i++) {
-        adc_sum += ring_buffer[tail].adc_val[i];
-
-        // LOG_INF("adc: ring_buffer[%d].adc_val[%d] = %d", tail, i,
-        // ring_buffer[tail].adc_val[i]);
+    const buf *block = adc_acq.Front(K_FOREVER);
+    if (block == nullptr) {
+      continue;
+    }
+    // every channel is a contiguous run: one linear pass per channel
+    for (size_t ch = 0; ch < adc_channel_count; ch++) {
+      uint32_t sum = 0;
+      for (size_t i = 0; i < buffer_mem_len; i++) {
+        sum += block->adc_val[ch][i];
+      }
+      adc_sum[ch] = sum;
+    }
+    for (size_t ch = 0; ch < adc_channel_count; ch++) {
+      for (size_t i = 0; i < buffer_mem_len; i++) {
+        filter_buf[ch][i] = block->adc_val[ch][i];
       }
-      l_tail = tail;
-      tail = ((tail + 1) % buffer_len);
+      adc_stats[ch].Add(block->adc_val[ch], buffer_mem_len);
+      // stream every raw channel before the slot is handed back, one frame
+      // per channel tagged with its index
+      size_t frame_len = telemetry_frame.Encode(ch, block->adc_val[ch]);
+#if UART_MUX
+      ARG_UNUSED(frame_len); // the mux does its own framing
+      uart_mux.Send(UartMux::kTelemetry, telemetry_frame.Payload(),
+                    telemetry_frame.kPayloadSize);
+#else
+      telemetry_port.Write(telemetry_frame.Data(), frame_len);
+#endif
+    }
 
 #if DBG
+    for (size_t ch = 0; ch < adc_channel_count; ch++) {
       for (uint8_t i = 0; i < buffer_mem_len; i++) {
-        LOG_INF("adc: ring_buffer[%d].adc_val[%d] = %d", l_tail, i,
-                ring_buffer[l_tail].adc_val[i]);
+        LOG_INF("adc: adc_val[%u][%d] = %d", (uint32_t)ch, i,
+                block->adc_val[ch][i]);
       }
-      LOG_INF("=========", "==========");
+    }
+    LOG_INF("=========", "==========");
 #endif
-      if (!k_mutex_lock(&avg_mutex, K_FOREVER)) {
-        avg_adc.store((float)(((float)adc_sum / (buffer_mem_len))));
-        k_mutex_unlock(&avg_mutex);
+    adc_acq.Release(); // the adc may refill the block from here on
+
+    for (size_t ch = 0; ch < adc_channel_count; ch++) {
+      adc_filter[ch].Process(filter_buf[ch], buffer_mem_len);
+      adc_filtered[ch].store(filter_buf[ch][buffer_mem_len - 1]);
+    }
+    adc_result_t result;
+    for (size_t ch = 0; ch < adc_channel_count; ch++) {
+      result.avg[ch] = (float)adc_sum[ch] / buffer_mem_len;
+      result.mv[ch] = adc_sum[ch] / buffer_mem_len;
+      if (adc_raw_to_millivolts_dt(&adc_channels[ch], &result.mv[ch])) {
+        result.mv[ch] = -1;
       }
     }
+    samples += buffer_mem_len;
+    result.timestamp_ms = k_uptime_get();
+    result.samples = samples;
+    result.overruns = adc_acq.Overruns();
+    adc_result.Write(result);
     // k_msleep(10 * UART_DELAY); // only to observe buffer full
   }
 }
 
+#if SPSC_BENCH
+// Ring handoff cost only: the k_sem wakeup is the same in both schemes.
+static void spsc_bench() {
+  constexpr size_t kBenchBlocks = 1000;
+  static volatile buf old_ring[buffer_len];
+  static volatile uint8_t old_head = 0;
+  static volatile uint8_t old_tail = 0;
+  static SpscRing<buf, buffer_len> new_ring;
+  uint32_t sum = 0;
+
+  uint32_t start = k_cycle_get_32();
+  for (size_t n = 0; n < kBenchBlocks; n++) {
+    if (((old_head + 1) % buffer_len) != old_tail) {
+      for (size_t i = 0; i < buffer_mem_len; i++) {
+        old_ring[old_head].adc_val[0][i] = n + i;
+      }
+      old_head = ((old_head + 1) % buffer_len);
+    }
+    if (old_head != old_tail) {
+      for (size_t i = 0; i < buffer_mem_len; i++) {
+        sum += old_ring[old_tail].adc_val[0][i];
+      }
+      old_tail = ((old_tail + 1) % buffer_len);
+    }
+  }
+  uint32_t old_cycles = k_cycle_get_32() - start;
+
+  start = k_cycle_get_32();
+  for (size_t n = 0; n < kBenchBlocks; n++) {
+    buf *block = new_ring.Reserve();
+    if (block != nullptr) {
+      for (size_t i = 0; i < buffer_mem_len; i++) {
+        block->adc_val[0][i] = n + i;
+      }
+      new_ring.Commit();
+    }
+    const buf *front = new_ring.Front();
+    if (front != nullptr) {
+      for (size_t i = 0; i < buffer_mem_len; i++) {
+        sum += front->adc_val[0][i];
+      }
+      new_ring.Release();
+    }
+  }
+  uint32_t new_cycles = k_cycle_get_32() - start;
+
+  LOG_INF("spsc bench: volatile ring %u, SpscRing %u cycles/block (sum %u)",
+          old_cycles / kBenchBlocks, new_cycles / kBenchBlocks, sum);
+}
+#endif
+
+// uart commands
+static int cmd_avg(const CommandArgs &args) {
+  adc_result_t result;
+  if (!adc_result.Read(result)) {
+    LOG_INF("No ADC block yet");
+    return -EAGAIN;
+  }
+  for (size_t ch = 0; ch < adc_channel_count; ch++) {
+    LOG_INF("ch%u: Average is %f, Voltage at Pin = %d mV", (uint32_t)ch,
+            result.avg[ch], result.mv[ch]);
+  }
+  LOG_INF("at %u ms: %u samples, %u overruns", (uint32_t)result.timestamp_ms,
+          result.samples, result.overruns);
+  return 0;
+}
+
+static int cmd_filter(const CommandArgs &args) {
+  for (size_t ch = 0; ch < adc_channel_count; ch++) {
+    int32_t val_mv = adc_filtered[ch].load();
+    LOG_INF("ch%u: Filtered is %d", (uint32_t)ch, val_mv);
+    if (!adc_raw_to_millivolts_dt(&adc_channels[ch], &val_mv)) {
+      LOG_INF("ch%u: Filtered voltage at Pin = %d mV", (uint32_t)ch, val_mv);
+    }
+    for (size_t i = 0; i < AdcFilter::kStages; i++) {
+      LOG_INF("ch%u: filter stage %s: %u cycles/sample", (uint32_t)ch,
+              AdcFilter::StageName(i), adc_filter[ch].CyclesPerSample(i));
+    }
+  }
+  return 0;
+}
+
+static void log_stats(size_t ch, const char *window, size_t len,
+                      const AdcStats::Summary &summary) {
+  char hist[AdcStats::kHistBins * 6 + 1];
+  size_t pos = 0;
+
+  LOG_INF("ch%u %s(%u): n %u min %u max %u mean %u.%02u var %u rms %u.%02u",
+          (uint32_t)ch, window, (uint32_t)len, summary.count, summary.min,
+          summary.max, summary.mean_c / 100, summary.mean_c % 100,
+          summary.variance, summary.rms_c / 100, summary.rms_c % 100);
+  for (uint32_t count : summary.hist) {
+    pos += snprintk(&hist[pos], sizeof(hist) - pos, " %u", count);
+    if (pos >= sizeof(hist)) {
+      break;
+    }
+  }
+  LOG_INF("ch%u %s hist:%s", (uint32_t)ch, window, hist);
+}
+
+static int cmd_stats(const CommandArgs &args) {
+  for (size_t ch = 0; ch < adc_channel_count; ch++) {
+    log_stats(ch, "sliding", AdcStats::kSlidingLen, adc_stats[ch].Sliding());
+    log_stats(ch, "tumbling", AdcStats::kTumblingLen,
+              adc_stats[ch].Tumbling());
+  }
+  return 0;
+}
+
+constexpr Command uart_commands[] = {
+    {"avg", cmd_avg, {}},
+    {"filter", cmd_filter, {}},
+    {"stats", cmd_stats, {}},
+};
+constexpr CommandTable uart_command_table{uart_commands};
+
+// The echo is coalesced: one Send() (one COBS packet with UART_MUX) per
+// line, full payload or rx burst instead of one per byte.
+#if UART_MUX
+constexpr size_t console_echo_size = UartMux::kMaxPayload;
+#else
+constexpr size_t console_echo_size = 64;
+#endif
+static uint8_t console_echo[console_echo_size];
+static size_t console_echo_len = 0;
+
+static void console_flush() {
+  if (!console_echo_len) {
+    return;
+  }
+#if UART_MUX
+  uart_mux.Send(UartMux::kConsole, console_echo, console_echo_len);
+#else
+  user_com_port.Write(console_echo, console_echo_len);
+#endif
+  console_echo_len = 0;
+}
+
+static void console_write(const unsigned char &buffer) {
+  console_echo[console_echo_len++] = buffer;
+  if (console_echo_len == console_echo_size || buffer == '\r' ||
+      buffer == '\n') {
+    console_flush();
+  }
+}
+
 static void uart_read_thread(void *param1, void *param2, void *param3) {
-  int ret = 0;
   size_t index = 0;
   size_t read_buff_size = 100;
   unsigned char read_buff[read_buff_size] = {'0'};
-  // LOG_INF("UART: Current cpu ID is %d", arch_curr_cpu()->id);
+
+  k_poll_event events[] = {K_POLL_EVENT_INITIALIZER(
+      K_POLL_TYPE_SIGNAL, K_POLL_MODE_NOTIFY_ONLY, &uart_rx_signal)};
+
   while (true) {
-    do {
-      while (!(ret = user_com_port.Read(read_buff[index]))) {
-        user_com_port.Write(read_buff[index++]);
-
-        if (index > read_buff_size - 1) {
-          index = read_buff_size - 1;
-          ret = 1;
-          break;
-        }
-        k_msleep(3 * UART_DELAY);
-      }
-    } while (!ret);
-
-    read_buff[index] = '\0';
-
-    if (index) {
-
-      if (!strcmp("avg\r", (const char *)read_buff) ||
-          !strcmp("avg\n", (const char *)read_buff)) {
-        float l_avg = 0.0f;
-        if (!k_mutex_lock(&avg_mutex, K_FOREVER)) {
-          l_avg = avg_adc.load();
-          k_mutex_unlock(&avg_mutex);
-        }
-        int32_t val_mv = (int32_t)l_avg;
-        int err = adc_raw_to_millivolts_dt(&adc_chan0, &val_mv);
-        if (err) {
-          LOG_ERR("Error in adc_raw_to_millivolts_dt: %d", err);
-          continue;
-        }
-        LOG_INF("Average is %f, Voltage at Pin = %u mV", l_avg, val_mv);
+    // sleep until the uart rx irq fires, no polling delay
+    k_poll(events, ARRAY_SIZE(events), K_FOREVER);
+    events[0].state = K_POLL_STATE_NOT_READY;
+
+    bool line_done = false;
+    while (!line_done && !user_com_port.Read(read_buff[index])) {
+      console_write(read_buff[index]);
+      line_done = (read_buff[index] == '\r' || read_buff[index] == '\n');
+      index++;
+
+      if (index > read_buff_size - 1) {
+        index = read_buff_size - 1;
+        line_done = true;
       }
     }
+    console_flush(); // rx fifo drained, echo what came in
 
-    memset(read_buff, 0, index + 1); // clear the local buffer
-    index = 0;
-    k_msleep(UART_DELAY);
+    if (line_done) {
+      read_buff[index] = '\0';
+      uart_command_table.Dispatch(reinterpret_cast<char *>(read_buff));
+#if DBG
+      LOG_INF("uart: byte-in to command-applied %u us",
+              k_cyc_to_us_floor32(k_cycle_get_32() - user_com_port.RxStamp()));
+#endif
+      memset(read_buff, 0, index + 1); // clear the local buffer
+      index = 0;
+    }
+    user_com_port.RearmRxSignal();
   }
 }
 
+#if UART_MUX
+static void uart_mux_thread(void *param1, void *param2, void *param3) {
+  uart_mux.Run();
+}
+#endif
+
 extern "C" int main(void) {
 
   // LOG_INF("Current cpu ID is %d", arch_curr_cpu()->id);
-  //  ADC ch 0 init
-  if (!device_is_ready(adc_chan0.dev)) {
-    LOG_ERR("ADC %s not ready\n", adc_chan0.dev->name);
+  // ADC init: one sequence scans all channels, buffer_mem_len times per
+  // trigger
+  int err = adc_acq.Init(adc_sample_interval_us);
+  if (err < 0) {
+    LOG_ERR("ADC channels failed (%d)\n", err);
     return 0;
   }
+#if CONFIG_ADC_EMUL
+  for (const adc_dt_spec &spec : adc_channels) {
+    adc_emul_value_func_set(spec.dev, spec.channel_id, adc_emul_sawtooth,
+                            nullptr);
+  }
+#endif
 
-  int err = adc_channel_setup_dt(&adc_chan0);
-  if (err < 0) {
-    LOG_ERR("ADC channel 0 failed (%d)\n", err);
+#if SPSC_BENCH
+  spsc_bench();
+#endif
+
+  if (!user_com_port.IsReady()) {
+    LOG_ERR("uart port not found...");
     return 0;
   }
 
-  if (k_mutex_init(&avg_mutex)) {
-    LOG_ERR("mutex avg_mutex init failed");
+  // -ENOSYS: no runtime configuration, keep the devicetree settings
+  err = user_com_port.Init();
+  if (err && err != -ENOSYS) {
+    LOG_ERR("uart config failed (%d)", err);
     return 0;
   }
 
-  if (k_sem_init(&signal_buff_full, 0, buffer_len)) {
-    LOG_ERR("semaphore signal_buff_full init failed");
+#if UART_MUX
+  if (uart_mux.Init()) {
+    LOG_ERR("uart mux init failed...");
     return 0;
   }
+  uart_mux.CaptureLogs();
 
-  if (!user_com_port.Init()) {
-    LOG_ERR("uart config failed ...");
+  thread_2_tid = k_thread_create(
+      &thread_2, stack_thread_2, K_THREAD_STACK_SIZEOF(stack_thread_2),
+      uart_mux_thread, NULL, NULL, NULL, thread_2_prio, 0, K_NO_WAIT);
+#else
+  if (!telemetry_port.IsReady()) {
+    LOG_ERR("telemetry uart port not found...");
+    return 0;
+  }
+  err = telemetry_port.Init();
+  if (err && err != -ENOSYS) {
+    LOG_ERR("telemetry uart config failed (%d)", err);
     return 0;
   }
+#endif
 
-  if (!user_com_port.IsReady()) {
-    LOG_ERR("uart port not found...");
+  k_poll_signal_init(&uart_rx_signal);
+  if (user_com_port.SetRxSignal(&uart_rx_signal)) {
+    LOG_ERR("uart rx irq setup failed...");
     return 0;
   }
 
@@ -0,0 +1,126 @@
+#include <zephyr/logging/log_backend.h>
+#include <zephyr/logging/log_ctrl.h>
+#include <zephyr/logging/log_output.h>
+
+#include "telemetry.h"
+#include "uartmux.h"
+
+UartMux::UartMux(UartPolling &port) : m_port(port) {}
+
+int UartMux::Init() {
+  k_msgq_init(&m_queue[kConsole], m_console_buffer, sizeof(packet_t),
+              kQueueLength[kConsole]);
+  k_msgq_init(&m_queue[kLog], m_log_buffer, sizeof(packet_t),
+              kQueueLength[kLog]);
+  k_msgq_init(&m_queue[kTelemetry], m_telemetry_buffer, sizeof(packet_t),
+              kQueueLength[kTelemetry]);
+
+  for (size_t i = 0; i < kChannelCount; i++) {
+    m_dropped[i].store(0);
+  }
+  return k_sem_init(&m_pending, 0, K_SEM_MAX_LIMIT);
+}
+
+int UartMux::Send(Channel channel, const uint8_t *data, size_t len) {
+  int ret = 0;
+  packet_t packet;
+
+  while (len) {
+    packet.len = MIN(len, kMaxPayload);
+    memcpy(packet.data, data, packet.len);
+    data += packet.len;
+    len -= packet.len;
+
+    // never block a producer: telemetry at full rate must not stall anyone
+    if (k_msgq_put(&m_queue[channel], &packet, K_NO_WAIT)) {
+      m_dropped[channel].fetch_add(1);
+      ret = -ENOMEM;
+    } else {
+      k_sem_give(&m_pending);
+    }
+  }
+  return ret;
+}
+
+int UartMux::Send(Channel channel, std::string_view data) {
+  return Send(channel, reinterpret_cast<const uint8_t *>(data.data()),
+              data.size());
+}
+
+void UartMux::Run() {
+  packet_t packet;
+  uint8_t raw[1 + kMaxPayload];
+  uint8_t frame[kMaxFrame];
+
+  while (true) {
+    k_sem_take(&m_pending, K_FOREVER);
+
+    // strict priority: rescan from the top for every packet
+    for (uint8_t channel = 0; channel < kChannelCount; channel++) {
+      if (k_msgq_get(&m_queue[channel], &packet, K_NO_WAIT)) {
+        continue;
+      }
+      raw[0] = channel;
+      memcpy(&raw[1], packet.data, packet.len);
+      size_t len = CobsEncode(raw, 1 + packet.len, frame);
+      frame[len++] = 0x00;
+      m_port.Write(frame, len);
+      break;
+    }
+  }
+}
+
+// Log backend feeding the log channel
+
+static UartMux *log_mux = nullptr;
+static uint8_t mux_log_buf[UartMux::kMaxPayload];
+
+static int mux_log_out(uint8_t *data, size_t length, void *ctx) {
+  ARG_UNUSED(ctx);
+  if (log_mux != nullptr) {
+    (void)log_mux->Send(UartMux::kLog, data, length);
+  }
+  return length;
+}
+
+LOG_OUTPUT_DEFINE(mux_log_output, mux_log_out, mux_log_buf,
+                  sizeof(mux_log_buf));
+
+static void mux_log_process(const struct log_backend *const backend,
+                            union log_msg_generic *msg) {
+  ARG_UNUSED(backend);
+  log_output_msg_process(&mux_log_output, &msg->log,
+                         LOG_OUTPUT_FLAG_LEVEL | LOG_OUTPUT_FLAG_TIMESTAMP);
+}
+
+static void mux_log_panic(const struct log_backend *const backend) {
+  ARG_UNUSED(backend);
+  log_output_flush(&mux_log_output);
+}
+
+static void mux_log_dropped(const struct log_backend *const backend,
+                            uint32_t cnt) {
+  ARG_UNUSED(backend);
+  log_output_dropped_process(&mux_log_output, cnt);
+}
+
+static const struct log_backend_api mux_log_api = {
+    .process = mux_log_process,
+    .dropped = mux_log_dropped,
+    .panic = mux_log_panic,
+};
+
+LOG_BACKEND_DEFINE(mux_log_backend, mux_log_api, false);
+
+int UartMux::CaptureLogs() {
+  // the raw uart backend would interleave plain text with the packets
+  const struct log_backend *uart_backend =
+      log_backend_get_by_name("log_backend_uart");
+  if (uart_backend != nullptr) {
+    log_backend_disable(uart_backend);
+  }
+
+  log_mux = this;
+  log_backend_enable(&mux_log_backend, nullptr, CONFIG_LOG_DEFAULT_LEVEL);
+  return 0;
+}
@@ -0,0 +1,68 @@
+#ifndef UARTPOLLING_H
+#define UARTPOLLING_H
+
+#include <string_view>
+
+#include <zephyr/drivers/uart.h>
+#include <zephyr/kernel.h>
+
+class UartPolling {
+private:
+  using ptr_device_const = const device *;
+  constexpr static ptr_device_const p_def_port =
+      (DEVICE_DT_GET(DT_ALIAS(usercom1)));
+  ptr_device_const m_port;
+
+  uart_config config;
+
+#if CONFIG_UART_INTERRUPT_DRIVEN
+  k_poll_signal *m_rx_signal = nullptr;
+  volatile uint32_t m_rx_stamp = 0; // cycle count of the last rx wakeup
+  // bulk Write(): the tx irq drains m_tx_buf into the fifo
+  k_mutex m_tx_lock;
+  k_sem m_tx_done;
+  const uint8_t *volatile m_tx_buf = nullptr;
+  volatile size_t m_tx_len = 0;
+  bool m_irq_set = false; // irq callback installed by Init()
+  bool m_tx_irq = true;   // SetTxIrq(false): bulk Write() polls
+  static void IrqHandler(const device *dev, void *user_data);
+#endif
+
+public:
+  // shared with the other uart backends (UartAsync)
+  constexpr static uart_config def_config = {.baudrate = 115200U,
+                                             .parity = UART_CFG_PARITY_NONE,
+                                             .stop_bits = UART_CFG_STOP_BITS_1,
+                                             .data_bits = UART_CFG_DATA_BITS_8,
+                                             .flow_ctrl =
+                                                 UART_CFG_FLOW_CTRL_NONE};
+
+  UartPolling(const ptr_device_const &p_user_port);
+  UartPolling(const ptr_device_const &p_user_port,
+              const uart_config &user_config);
+  int Init();
+  int IsReady();
+  int DeInit();
+  void Write(const uint16_t &buffer);
+  int Read(uint16_t &buffer);
+  void Write(const unsigned char &buffer);
+  int Read(unsigned char &buffer);
+  // whole buffer in one call instead of one Write() per character; with
+  // the irq api it is handed to uart_fifo_fill() from the tx irq
+  void Write(const uint8_t *buffer, size_t len);
+  void Write(std::string_view buffer);
+
+#if CONFIG_UART_INTERRUPT_DRIVEN
+  // Event driven reads: the rx irq raises signal and masks itself, the
+  // reader k_poll()s on it, drains with Read() and calls RearmRxSignal().
+  int SetRxSignal(k_poll_signal *signal);
+  void RearmRxSignal();
+  uint32_t RxStamp() const { return m_rx_stamp; }
+  // bulk Write() through the tx irq (default) or the uart_poll_out() loop
+  void SetTxIrq(bool enable) { m_tx_irq = enable; }
+#endif
+
+  ~UartPolling() = default;
+};
+
+#endif // UARTPOLLING_H
@@ -0,0 +1,78 @@
+#ifndef UARTPORT_H
+#define UARTPORT_H
+
+#include <string_view>
+#include <type_traits>
+
+#include <zephyr/drivers/uart.h>
+#include <zephyr/kernel.h>
+
+// Compile time bound version of UartPolling: the device and its config are
+// template arguments, so every call sees a constant device pointer (no
+// m_port load, no out of line member call) and an instance holds no state.
+//
+//   using ConsolePort = UartPort<DEVICE_DT_GET(DT_ALIAS(usercom1))>;
+//   ConsolePort::Write("hello\n\r");
+
+inline constexpr uart_config kUartPortDefConfig = {
+    .baudrate = 115200U,
+    .parity = UART_CFG_PARITY_NONE,
+    .stop_bits = UART_CFG_STOP_BITS_1,
+    .data_bits = UART_CFG_DATA_BITS_8,
+    .flow_ctrl = UART_CFG_FLOW_CTRL_NONE};
+
+template <const device *kPort, const uart_config *kConfig = &kUartPortDefConfig>
+class UartPort {
+public:
+  constexpr static const device *port = kPort;
+  constexpr static const uart_config *config = kConfig;
+
+  static int Init() { return uart_configure(kPort, kConfig); }
+
+  static int IsReady() { return device_is_ready(kPort); }
+
+  static int DeInit() {
+    uart_rx_disable(kPort);
+    return 0;
+  }
+
+  static void Write(const unsigned char &buffer) {
+    uart_poll_out(kPort, buffer);
+  }
+
+  static int Read(unsigned char &buffer) {
+    int ret = uart_poll_in(kPort, &buffer);
+    if (ret) {
+      buffer = '\0';
+    }
+    return ret;
+  }
+
+  static void Write(const uint16_t &buffer) { uart_poll_out_u16(kPort, buffer); }
+
+  static int Read(uint16_t &buffer) {
+    int ret = uart_poll_in_u16(kPort, &buffer);
+    if (ret) {
+      buffer = '\0';
+    }
+    return ret;
+  }
+
+  static void Write(const uint8_t *buffer, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+      uart_poll_out(kPort, buffer[i]);
+    }
+  }
+
+  static void Write(std::string_view buffer) {
+    Write(reinterpret_cast<const uint8_t *>(buffer.data()), buffer.size());
+  }
+};
+
+// usercom1 as a type, the same device as UartPolling::p_def_port
+#if DT_NODE_EXISTS(DT_ALIAS(usercom1))
+using DefUartPort = UartPort<DEVICE_DT_GET(DT_ALIAS(usercom1))>;
+static_assert(std::is_empty_v<DefUartPort>, "UartPort must not hold state");
+#endif
+
+#endif // UARTPORT_H
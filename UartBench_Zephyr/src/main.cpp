@@ -0,0 +1,349 @@
+/**
+ * UART console path benchmark
+ *
+ * Drives every uart backend (UartPolling, UartPort, UartIrq, UartAsync)
+ * through a native_sim uart emulator and reports, per backend:
+ * bytes moved, cycles per byte spent inside the backend calls, bytes/s and
+ * commands/s over the elapsed time of the test, dropped bytes and p50/p99
+ * echo latency (byte injected -> echo seen on tx).
+ * "polling" vs "port" is the runtime device pointer vs the compile time
+ * bound template, both run the same poll_in/poll_out calls on one emulator.
+ * "polling+txirq" is UartPolling again with its bulk Write() going through
+ * the tx irq and uart_fifo_fill(), the default in the Soln apps.
+ *
+ * Results are printed as CSV lines starting with "BENCH," so a CI job can
+ * diff them; main() exits with 1 when a paced test dropped bytes.
+ *
+ * Run headless: west build -b native_sim UartBench_Zephyr && \
+ *               ./build/zephyr/zephyr.exe
+ */
+#include <algorithm>
+#include <cstring>
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/serial/uart_emul.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#if CONFIG_ARCH_POSIX
+#include <posix_board_if.h>
+#endif
+
+#include "command.h"
+#include "uartasync.h"
+#include "uartirq.h"
+#include "uartpolling.h"
+#include "uartport.h"
+
+LOG_MODULE_REGISTER(main, CONFIG_LOG_DEFAULT_LEVEL);
+
+constexpr size_t kBenchBytes = 16 * 1024; // per throughput test
+constexpr size_t kChunk = 128;            // <= emulator fifo sizes
+constexpr size_t kEchoSamples = 200;
+constexpr int kMaxIdle = 100; // empty polls before a transfer is given up
+
+constexpr const device *polling_port = DEVICE_DT_GET(DT_ALIAS(bench_polling));
+constexpr const device *irq_port = DEVICE_DT_GET(DT_ALIAS(bench_irq));
+constexpr const device *async_port = DEVICE_DT_GET(DT_ALIAS(bench_async));
+
+UartPolling polling_uart{polling_port};
+UartPort<DEVICE_DT_GET(DT_ALIAS(bench_polling))> port_uart; // no state
+UartIrq irq_uart{irq_port};
+UartAsync async_uart{async_port};
+
+constexpr size_t kCommandLines = 500;
+
+static uint32_t echo_latency[kEchoSamples];
+static bool bench_failed = false;
+#if CONFIG_ARCH_POSIX && (defined(__x86_64__) || defined(__i386__))
+static uint64_t host_tsc_hz = 0; // from bench_calibrate()
+#endif
+
+// native_sim runs code in zero simulated time, so k_cycle_get_32() does not
+// see the cpu cost there: use the host time stamp counter instead.
+static inline uint32_t bench_cycles() {
+#if CONFIG_ARCH_POSIX && (defined(__x86_64__) || defined(__i386__))
+  return static_cast<uint32_t>(__builtin_ia32_rdtsc());
+#else
+  return k_cycle_get_32();
+#endif
+}
+
+// Elapsed time for the rates. native_sim does not advance k_uptime while
+// code runs, only across sleeps, so there it is the host TSC scaled by its
+// rate, measured once against a real time sleep.
+#if CONFIG_ARCH_POSIX && (defined(__x86_64__) || defined(__i386__))
+static void bench_calibrate() {
+  uint64_t start = __builtin_ia32_rdtsc();
+  k_msleep(100); // real time with NATIVE_SIM_SLOWDOWN_TO_REAL_TIME
+  host_tsc_hz = (__builtin_ia32_rdtsc() - start) * 10;
+}
+
+static inline uint64_t bench_now_us() {
+  return host_tsc_hz ? __builtin_ia32_rdtsc() * 1000000 / host_tsc_hz : 0;
+}
+#else
+static void bench_calibrate() {}
+
+static inline uint64_t bench_now_us() {
+  return k_ticks_to_us_floor64(k_uptime_ticks());
+}
+#endif
+
+static inline uint32_t bench_rate(size_t count, uint64_t elapsed_us) {
+  return elapsed_us ? static_cast<uint32_t>((uint64_t)count * 1000000 /
+                                            elapsed_us)
+                    : 0;
+}
+
+static void bench_report(const char *backend, const char *test, size_t bytes,
+                         uint64_t cycles, size_t dropped,
+                         uint64_t elapsed_us) {
+  uint32_t per_byte = bytes ? static_cast<uint32_t>(cycles / bytes) : 0;
+  LOG_INF("BENCH,%s,%s,bytes=%u,cycles_per_byte=%u,bytes_per_sec=%u,"
+          "dropped=%u",
+          backend, test, (uint32_t)bytes, per_byte,
+          bench_rate(bytes, elapsed_us), (uint32_t)dropped);
+}
+
+static void bench_report_latency(const char *backend, size_t samples) {
+  if (!samples) {
+    LOG_INF("BENCH,%s,echo,samples=0", backend);
+    return;
+  }
+  std::sort(echo_latency, echo_latency + samples);
+  LOG_INF("BENCH,%s,echo,samples=%u,p50_cycles=%u,p99_cycles=%u", backend,
+          (uint32_t)samples, echo_latency[samples / 2],
+          echo_latency[(samples * 99) / 100]);
+}
+
+// Pulls everything the backend transmitted out of the emulator.
+static size_t bench_drain_tx(const device *port, size_t expected) {
+  static uint8_t sink[kChunk];
+  size_t drained = 0;
+  int idle = 0;
+
+  while (drained < expected && idle < kMaxIdle) {
+    uint32_t len = uart_emul_get_tx_data(port, sink, sizeof(sink));
+    if (len) {
+      drained += len;
+      idle = 0;
+    } else {
+      idle++;
+      k_sleep(K_TICKS(1)); // let the emulator irq work run
+    }
+  }
+  return drained;
+}
+
+template <typename Uart>
+static size_t bench_read(Uart &uart, size_t count, uint64_t &cycles) {
+  size_t got = 0;
+  int idle = 0;
+
+  while (got < count && idle < kMaxIdle) {
+    unsigned char c;
+    uint32_t start = bench_cycles();
+    int ret = uart.Read(c);
+    cycles += bench_cycles() - start;
+
+    if (!ret) {
+      got++;
+      idle = 0;
+    } else {
+      idle++;
+      k_sleep(K_TICKS(1));
+    }
+  }
+  return got;
+}
+
+static uint32_t bench_delay_ms = 0;
+
+static int bench_cmd_delay(const CommandArgs &args) {
+  bench_delay_ms = args.value[1];
+  return 0;
+}
+
+constexpr Command bench_commands_list[] = {
+    {"delay", bench_cmd_delay, {ArgType::kUint}},
+};
+constexpr CommandTable bench_command_table{bench_commands_list};
+
+// commands: "delay <n>\r" in -> Read() line -> Dispatch() -> "ok\r\n" out,
+// the console round trip of the Soln apps
+template <typename Uart>
+static void bench_commands(const char *name, Uart &uart, const device *port) {
+  constexpr std::string_view reply = "ok\r\n";
+  char line[32];
+  size_t done = 0;
+
+  uint64_t begin = bench_now_us();
+  for (size_t i = 0; i < kCommandLines; i++) {
+    int len = snprintk(line, sizeof(line), "delay %u\r", (uint32_t)i);
+    uart_emul_put_rx_data(port, reinterpret_cast<uint8_t *>(line), len);
+
+    size_t index = 0;
+    int idle = 0;
+    while (idle < kMaxIdle && index < sizeof(line) - 1) {
+      unsigned char c;
+      if (uart.Read(c)) {
+        idle++;
+        k_sleep(K_TICKS(1));
+        continue;
+      }
+      idle = 0;
+      line[index++] = c;
+      if (c == '\r') {
+        break;
+      }
+    }
+    line[index] = '\0';
+
+    if (bench_command_table.Dispatch(line) || bench_delay_ms != i) {
+      continue;
+    }
+    uart.Write(reply);
+    if (bench_drain_tx(port, reply.size()) == reply.size()) {
+      done++;
+    }
+  }
+  uint64_t elapsed_us = bench_now_us() - begin;
+
+  LOG_INF("BENCH,%s,cmd,commands=%u,commands_per_sec=%u,failed=%u", name,
+          (uint32_t)done, bench_rate(done, elapsed_us),
+          (uint32_t)(kCommandLines - done));
+  bench_failed |= (done != kCommandLines);
+}
+
+template <typename Uart>
+static void bench_byte_backend(const char *name, Uart &uart,
+                               const device *port) {
+  static uint8_t pattern[kChunk];
+  for (size_t i = 0; i < kChunk; i++) {
+    pattern[i] = 'a' + (i % 26);
+  }
+
+  // rx: emulator -> backend
+  uint64_t cycles = 0;
+  size_t received = 0;
+  uint64_t begin = bench_now_us();
+  for (size_t sent = 0; sent < kBenchBytes; sent += kChunk) {
+    uint32_t put = uart_emul_put_rx_data(port, pattern, kChunk);
+    received += bench_read(uart, put, cycles);
+  }
+  bench_report(name, "rx", received, cycles, kBenchBytes - received,
+               bench_now_us() - begin);
+  bench_failed |= (received != kBenchBytes);
+
+  // tx: backend -> emulator, one bulk Write() per chunk
+  cycles = 0;
+  size_t drained = 0;
+  begin = bench_now_us();
+  for (size_t sent = 0; sent < kBenchBytes; sent += kChunk) {
+    uint32_t start = bench_cycles();
+    uart.Write(pattern, kChunk);
+    cycles += bench_cycles() - start;
+    drained += bench_drain_tx(port, kChunk);
+  }
+  bench_report(name, "tx", drained, cycles, kBenchBytes - drained,
+               bench_now_us() - begin);
+  bench_failed |= (drained != kBenchBytes);
+
+  // echo: byte in -> Read() -> Write() -> byte out
+  size_t samples = 0;
+  for (size_t i = 0; i < kEchoSamples; i++) {
+    uint8_t c = pattern[i % kChunk];
+    uint64_t unused = 0;
+    uint32_t start = bench_cycles();
+
+    uart_emul_put_rx_data(port, &c, 1);
+    if (bench_read(uart, 1, unused) != 1) {
+      continue;
+    }
+    uart.Write(c);
+    if (bench_drain_tx(port, 1) != 1) {
+      continue;
+    }
+    echo_latency[samples++] = bench_cycles() - start;
+  }
+  bench_report_latency(name, samples);
+  bench_failed |= (samples != kEchoSamples);
+
+  bench_commands(name, uart, port);
+}
+
+// UartAsync delivers lines, so it is fed with '\n' terminated chunks.
+static void bench_async_backend(const char *name, UartAsync &uart,
+                                const device *port) {
+  constexpr size_t kLineLen = 16;
+  static uint8_t line_pattern[kLineLen];
+  for (size_t i = 0; i < kLineLen - 1; i++) {
+    line_pattern[i] = 'a' + i;
+  }
+  line_pattern[kLineLen - 1] = '\n';
+
+  uint64_t cycles = 0;
+  size_t received = 0;
+  uint64_t begin = bench_now_us();
+  for (size_t sent = 0; sent < kBenchBytes; sent += kLineLen) {
+    uart_emul_put_rx_data(port, line_pattern, kLineLen);
+
+    UartAsync::Line line;
+    uint32_t start = bench_cycles();
+    int ret = uart.ReadLine(line, K_MSEC(10));
+    cycles += bench_cycles() - start;
+    if (!ret) {
+      received += line.head.len + line.tail.len;
+      uart.Release(line);
+    }
+  }
+  bench_report(name, "rx_lines", received, cycles, kBenchBytes - received,
+               bench_now_us() - begin);
+  LOG_INF("BENCH,%s,rx_lines,dropped=%u,rx_errors=%u", name, uart.Dropped(),
+          uart.RxErrors());
+  bench_failed |= (received != kBenchBytes);
+}
+
+extern "C" int main(void) {
+
+  LOG_INF("---uart benchmark: %u bytes per test---", (uint32_t)kBenchBytes);
+  bench_calibrate();
+
+  if (!polling_uart.IsReady() || !irq_uart.IsReady() ||
+      !async_uart.IsReady()) {
+    LOG_ERR("uart emulator not found...");
+    return 0;
+  }
+
+  polling_uart.Init(); // -ENOSYS without runtime configure is fine here
+#if CONFIG_UART_INTERRUPT_DRIVEN
+  polling_uart.SetTxIrq(false);
+#endif
+  bench_byte_backend("polling", polling_uart, polling_port);
+  bench_byte_backend("port", port_uart, polling_port);
+#if CONFIG_UART_INTERRUPT_DRIVEN
+  polling_uart.SetTxIrq(true);
+  bench_byte_backend("polling+txirq", polling_uart, polling_port);
+#endif
+
+  if (irq_uart.Init()) {
+    LOG_ERR("uart irq init failed...");
+  } else {
+    bench_byte_backend("irq", irq_uart, irq_port);
+    LOG_INF("BENCH,irq,rx,ring_dropped=%u", irq_uart.Dropped());
+  }
+
+  if (async_uart.Init()) {
+    LOG_ERR("uart async init failed...");
+  } else {
+    bench_async_backend("async", async_uart, async_port);
+  }
+
+  LOG_INF("---uart benchmark %s---", bench_failed ? "FAILED" : "done");
+
+#if CONFIG_ARCH_POSIX
+  posix_exit(bench_failed ? 1 : 0);
+#endif
+  return 0;
+}
@@ -0,0 +1,232 @@
+#include "uartasync.h"
+
+UartAsync::UartAsync(const ptr_device_const &p_user_port = p_def_port,
+                     const uart_config &user_config = UartPolling::def_config)
+    : m_port(p_user_port), config(user_config) {}
+
+UartAsync::UartAsync(const ptr_device_const &p_user_port = p_def_port)
+    : m_port(p_user_port), config(UartPolling::def_config) {}
+
+int UartAsync::Init() {
+  k_msgq_init(&m_rx_queue, m_rx_queue_buffer, sizeof(rx_event_t),
+              kRxQueueLength);
+
+  for (size_t i = 0; i < kRxBufferCount; i++) {
+    m_driver_owned[i] = false;
+    m_holds[i] = 0;
+  }
+  m_rsp_pending = false;
+  m_rx_stopped = false;
+  m_stopping = false;
+  m_seg_valid = false;
+  m_line_open = false;
+
+  // -ENOSYS: no runtime configuration, keep the devicetree settings
+  int ret = uart_configure(m_port, &config);
+  if (ret && ret != -ENOSYS) {
+    return ret;
+  }
+
+  ret = uart_callback_set(m_port, Callback, this);
+  if (ret) {
+    return ret;
+  }
+
+  m_driver_owned[0] = true;
+  return uart_rx_enable(m_port, m_rx_buf[0], kRxBufferSize, kRxTimeoutUs);
+}
+
+int UartAsync::IsReady() { return device_is_ready(m_port); }
+
+int UartAsync::DeInit() {
+  k_spinlock_key_t key = k_spin_lock(&m_lock);
+  m_stopping = true;
+  k_spin_unlock(&m_lock, key);
+  return uart_rx_disable(m_port);
+}
+
+void UartAsync::Write(const unsigned char &buffer) {
+  uart_poll_out(m_port, buffer);
+}
+
+void UartAsync::Write(const uint8_t *buffer, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    uart_poll_out(m_port, buffer[i]);
+  }
+}
+
+void UartAsync::Write(std::string_view buffer) {
+  Write(reinterpret_cast<const uint8_t *>(buffer.data()), buffer.size());
+}
+
+uint8_t UartAsync::IndexOf(const unsigned char *data) const {
+  return (data - &m_rx_buf[0][0]) / kRxBufferSize;
+}
+
+// Called with m_lock held: hand a buffer back to the driver once it is
+// neither being filled nor referenced by a queued segment or a line.
+void UartAsync::Recycle(uint8_t buf) {
+  if (m_driver_owned[buf] || m_holds[buf]) {
+    return;
+  }
+
+  if (m_rsp_pending) {
+    m_rsp_pending = false;
+    m_driver_owned[buf] = true;
+    uart_rx_buf_rsp(m_port, m_rx_buf[buf], kRxBufferSize);
+  } else if (m_rx_stopped && !m_stopping) {
+    m_rx_stopped = false;
+    m_driver_owned[buf] = true;
+    uart_rx_enable(m_port, m_rx_buf[buf], kRxBufferSize, kRxTimeoutUs);
+  }
+}
+
+void UartAsync::Hold(uint8_t buf) {
+  k_spinlock_key_t key = k_spin_lock(&m_lock);
+  m_holds[buf]++;
+  k_spin_unlock(&m_lock, key);
+}
+
+void UartAsync::Drop(uint8_t buf) {
+  k_spinlock_key_t key = k_spin_lock(&m_lock);
+  m_holds[buf]--;
+  Recycle(buf);
+  k_spin_unlock(&m_lock, key);
+}
+
+void UartAsync::Callback(const device *dev, uart_event *evt,
+                         void *user_data) {
+  UartAsync *self = static_cast<UartAsync *>(user_data);
+  k_spinlock_key_t key = k_spin_lock(&self->m_lock);
+
+  switch (evt->type) {
+  case UART_RX_RDY: {
+    rx_event_t seg = {.type = RxEventType::kReady,
+                      .buf = self->IndexOf(evt->data.rx.buf),
+                      .offset = static_cast<uint16_t>(evt->data.rx.offset),
+                      .len = static_cast<uint16_t>(evt->data.rx.len)};
+    if (k_msgq_put(&self->m_rx_queue, &seg, K_NO_WAIT)) {
+      self->m_dropped_bytes.fetch_add(seg.len);
+    } else {
+      self->m_holds[seg.buf]++; // released once the consumer scanned it
+    }
+    break;
+  }
+  case UART_RX_BUF_REQUEST: {
+    bool found = false;
+    for (uint8_t i = 0; i < kRxBufferCount && !found; i++) {
+      if (!self->m_driver_owned[i] && !self->m_holds[i]) {
+        self->m_driver_owned[i] = true;
+        uart_rx_buf_rsp(dev, self->m_rx_buf[i], kRxBufferSize);
+        found = true;
+      }
+    }
+    // none free: respond later from Recycle(), when the consumer lets go
+    self->m_rsp_pending = !found;
+    break;
+  }
+  case UART_RX_BUF_RELEASED: {
+    uint8_t buf = self->IndexOf(evt->data.rx_buf.buf);
+    self->m_driver_owned[buf] = false;
+    self->Recycle(buf);
+    break;
+  }
+  case UART_RX_DISABLED: {
+    // the driver ran out of buffers (consumer too slow) or DeInit()
+    self->m_rsp_pending = false;
+    self->m_rx_stopped = true;
+    if (!self->m_stopping) {
+      self->m_rx_errors.fetch_add(1);
+    }
+    rx_event_t stop = {.type = RxEventType::kStopped};
+    (void)k_msgq_put(&self->m_rx_queue, &stop, K_NO_WAIT);
+    for (uint8_t i = 0; i < kRxBufferCount; i++) {
+      self->Recycle(i);
+    }
+    break;
+  }
+  case UART_RX_STOPPED:
+    self->m_rx_errors.fetch_add(1);
+    break;
+  default:
+    break;
+  }
+
+  k_spin_unlock(&self->m_lock, key);
+}
+
+void UartAsync::CloseLine(Line &line, bool truncated) {
+  const unsigned char *start = &m_rx_buf[m_line_buf][m_line_off];
+
+  if (!m_line_wrapped) {
+    line.head = {start, m_line_len};
+    line.tail = {nullptr, 0};
+  } else {
+    line.head = {start, m_head_len};
+    line.tail = {&m_rx_buf[m_tail_buf][0], m_line_len - m_head_len};
+  }
+  line.truncated = truncated;
+  m_line_open = false;
+}
+
+int UartAsync::ReadLine(Line &line, k_timeout_t timeout) {
+  while (true) {
+    if (!m_seg_valid) {
+      if (k_msgq_get(&m_rx_queue, &m_seg, timeout)) {
+        return -EAGAIN;
+      }
+      if (m_seg.type == RxEventType::kStopped) {
+        // deliver what we have, its buffers must go back to the driver
+        if (m_line_open) {
+          CloseLine(line, true);
+          return 0;
+        }
+        continue;
+      }
+      m_seg_pos = 0;
+      m_seg_valid = true;
+    }
+
+    const unsigned char *data = &m_rx_buf[m_seg.buf][m_seg.offset];
+
+    if (!m_line_open) {
+      Hold(m_seg.buf);
+      m_line_open = true;
+      m_line_wrapped = false;
+      m_line_buf = m_seg.buf;
+      m_line_off = m_seg.offset + m_seg_pos;
+      m_line_len = 0;
+    } else if (m_seg.buf != m_line_buf && !m_line_wrapped) {
+      Hold(m_seg.buf);
+      m_line_wrapped = true;
+      m_tail_buf = m_seg.buf;
+      m_head_len = m_line_len;
+    }
+
+    bool line_done = false;
+    while (m_seg_pos < m_seg.len && !line_done) {
+      unsigned char c = data[m_seg_pos++];
+      m_line_len++;
+      line_done = (c == '\n' || c == '\r');
+    }
+
+    if (m_seg_pos >= m_seg.len) {
+      m_seg_valid = false;
+      Drop(m_seg.buf); // segment scanned, the line keeps its own hold
+    }
+
+    if (line_done) {
+      CloseLine(line, false);
+      return 0;
+    }
+  }
+}
+
+void UartAsync::Release(const Line &line) {
+  if (line.head.data) {
+    Drop(IndexOf(line.head.data));
+  }
+  if (line.tail.data) {
+    Drop(IndexOf(line.tail.data));
+  }
+}
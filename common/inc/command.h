@@ -0,0 +1,154 @@
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include <zephyr/kernel.h>
+
+// Uart command layer: the line buffer is tokenized in place (separators are
+// overwritten with '\0', no copies, no scanf) and the command name is looked
+// up by binary search in a table that is sorted at compile time.
+//
+// Shared by the Soln apps, each CMakeLists adds common/inc to the includes.
+
+constexpr size_t kCmdMaxArgs = 4; // command name included
+
+enum class ArgType : uint8_t { kNone = 0, kUint };
+
+struct CommandArgs {
+  size_t argc;
+  const char *argv[kCmdMaxArgs];
+  uint32_t value[kCmdMaxArgs]; // parsed kUint arguments, by position
+};
+
+using command_handler_t = int (*)(const CommandArgs &args);
+
+struct Command {
+  std::string_view name;
+  command_handler_t handler;
+  ArgType arg[kCmdMaxArgs - 1]; // argument schema, kNone terminated
+};
+
+// Splits line on blanks/CR/LF, returns the number of tokens stored in argv
+// or -E2BIG when the line has more than max_args tokens.
+inline int CommandTokenize(char *line, const char *argv[], size_t max_args) {
+  size_t argc = 0;
+  bool in_token = false;
+
+  for (char *c = line; *c != '\0'; c++) {
+    bool sep = (*c == ' ' || *c == '\t' || *c == '\r' || *c == '\n');
+    if (sep) {
+      *c = '\0';
+      in_token = false;
+    } else if (!in_token) {
+      if (argc == max_args) {
+        return -E2BIG;
+      }
+      argv[argc++] = c;
+      in_token = true;
+    }
+  }
+  return static_cast<int>(argc);
+}
+
+// Bounded decimal parse, fails on empty input, non digits and overflow.
+inline bool CommandParseUint(const char *str, uint32_t &value) {
+  uint32_t result = 0;
+
+  if (*str == '\0') {
+    return false;
+  }
+  for (; *str != '\0'; str++) {
+    if (*str < '0' || *str > '9') {
+      return false;
+    }
+    uint32_t digit = *str - '0';
+    if (result > (UINT32_MAX - digit) / 10U) {
+      return false;
+    }
+    result = result * 10U + digit;
+  }
+  value = result;
+  return true;
+}
+
+template <size_t N> class CommandTable {
+  std::array<Command, N> m_commands;
+
+public:
+  constexpr CommandTable(const Command (&commands)[N]) : m_commands{} {
+    // insertion sort, runs at compile time for constexpr tables
+    for (size_t i = 0; i < N; i++) {
+      m_commands[i] = commands[i];
+      for (size_t j = i; j > 0 && m_commands[j].name < m_commands[j - 1].name;
+           j--) {
+        Command tmp = m_commands[j];
+        m_commands[j] = m_commands[j - 1];
+        m_commands[j - 1] = tmp;
+      }
+    }
+  }
+
+  constexpr const Command *Find(std::string_view name) const {
+    size_t low = 0;
+    size_t high = N;
+    while (low < high) {
+      size_t mid = low + (high - low) / 2;
+      if (m_commands[mid].name == name) {
+        return &m_commands[mid];
+      }
+      if (m_commands[mid].name < name) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    return nullptr;
+  }
+
+  // Returns the handler result, -ENOENT for an unknown command (or an empty
+  // line), -E2BIG for too many tokens and -EINVAL when the arguments do not
+  // match the schema.
+  int Dispatch(char *line) const {
+    CommandArgs args;
+    int argc = CommandTokenize(line, args.argv, kCmdMaxArgs);
+    if (argc < 0) {
+      return argc;
+    }
+    args.argc = argc;
+    return Dispatch(args);
+  }
+
+  // For callers that already tokenized the line (argv filled, argc set).
+  int Dispatch(CommandArgs &args) const {
+    if (!args.argc) {
+      return -ENOENT;
+    }
+
+    const Command *cmd = Find(args.argv[0]);
+    if (cmd == nullptr) {
+      return -ENOENT;
+    }
+
+    size_t expected = 0;
+    while (expected < kCmdMaxArgs - 1 && cmd->arg[expected] != ArgType::kNone) {
+      expected++;
+    }
+    if (args.argc - 1 != expected) {
+      return -EINVAL;
+    }
+
+    for (size_t i = 0; i < expected; i++) {
+      if (cmd->arg[i] == ArgType::kUint &&
+          !CommandParseUint(args.argv[i + 1], args.value[i + 1])) {
+        return -EINVAL;
+      }
+    }
+    return cmd->handler(args);
+  }
+};
+
+#endif // COMMAND_H